@@ -0,0 +1,396 @@
+/*********************************************************************************************************************************************************
+Benchmark for the 'Path_maker' interpreter.
+
+    Generates a synthetic script of a given shape and size, then runs it several times against a fresh directory on a tmpfs root, timing each phase
+    of the interpreter separately:
+
+    lex       source text to tokens
+    compile   tokens to the instruction array; this is the pass that validates the whole script before anything runs
+    execute   running the instructions, including the directories they create
+    total     all three together
+
+    Shapes:
+
+    chain     make statements of long directory chains (--depth names each)
+    fanout    make statements of directories side by side under a few parents
+    nested    if/ifnot guards nested --depth deep around make statements
+    parents   go down --depth directories, then make paths that climb back up with long '*' sequences
+    mixed     the four shapes above in turn
+
+    The existence cache is re-checked against the disk, as path_maker does by default; --cache trust measures '--cache trust' instead. The policy is
+    part of the results, so numbers of the two are not compared by mistake.
+
+    Results are written as one JSON object (to --out FILE, or standard output) so runs on different commits can be compared. With --generate FILE the
+    script is only written to FILE, to be run with path_maker itself.
+
+    Build: the 'Bench' target of path_maker.cbp, or
+    gcc -O2 -pthread bench/bench.c -o path_maker_bench
+***************************************************************************************************************************************************************/
+
+
+#define PATH_MAKER_NO_MAIN
+#include "../main.c"
+#include <ftw.h>
+#include <time.h>
+
+
+// Benchmark settings, from the command line
+typedef struct
+{
+    const char* shape;
+    // Number of top-level statements (or groups of statements) to generate
+    int size;
+    // Length of chains, nesting depth, and number of '*' operators, depending on the shape
+    int depth;
+    int runs;
+    int threads;
+    // '--cache trust' instead of the default '--cache verify'
+    bool trust_cache;
+    // Directory (normally on a tmpfs) in which each run gets a fresh directory
+    const char* root;
+    const char* out;
+    const char* generate;
+} BenchOptions;
+
+// Time of each phase in each run, in seconds
+typedef struct
+{
+    double* lex;
+    double* compile;
+    double* execute;
+    double* total;
+} BenchTimes;
+
+
+// Function prototypes
+bool generate_script(FILE* fptr, const BenchOptions* options);
+void generate_chain(FILE* fptr, int size, int depth);
+void generate_fanout(FILE* fptr, int size);
+void generate_nested(FILE* fptr, int size, int depth);
+void generate_parents(FILE* fptr, int size, int depth);
+double now(void);
+int compare_times(const void* a, const void* b);
+void write_phase(FILE* fptr, const char* name, double* times, int runs, bool last);
+int remove_entry(const char* path, const struct stat* sb, int flag, struct FTW* ftw);
+
+
+// Benchmark program logic
+int main(int argc, char* argv[])
+{
+    BenchOptions options = {"mixed", 1000, 16, 5, 1, false, "/dev/shm", NULL, NULL};
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--shape") && i + 1 < argc)
+        {
+            options.shape = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--size") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            options.size = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--depth") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            options.depth = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--runs") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            options.runs = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--cache") && i + 1 < argc
+                 && (!strcmp(argv[i + 1], "trust") || !strcmp(argv[i + 1], "verify")))
+        {
+            options.trust_cache = !strcmp(argv[++i], "trust");
+        }
+        else if (!strcmp(argv[i], "--root") && i + 1 < argc)
+        {
+            options.root = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+        {
+            options.out = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--generate") && i + 1 < argc)
+        {
+            options.generate = argv[++i];
+        }
+        else
+        {
+            printf("Error. Unknown option: %s\nUsage: %s [--shape chain|fanout|nested|parents|mixed] [--size N] [--depth N] [--runs N] [--threads N] [--cache trust|verify] [--root DIR] [--out FILE] [--generate FILE]\n", argv[i], argv[0]);
+            return 1;
+        }
+    }
+
+    // Generate the script in memory, as the lexer sees a mapped file
+    char* source = NULL;
+    size_t size = 0;
+    FILE* fptr = open_memstream(&source, &size);
+    if (fptr == NULL || !generate_script(fptr, &options) || fclose(fptr) != 0)
+    {
+        printf("Error. Unknown shape: %s\n", options.shape);
+        return 1;
+    }
+    if (options.generate != NULL)
+    {
+        FILE* script = fopen(options.generate, "w");
+        if (script == NULL || fwrite(source, 1, size, script) != size || fclose(script) != 0)
+        {
+            printf("Error writing %s.\n", options.generate);
+            return 1;
+        }
+        free(source);
+        return 0;
+    }
+
+    BenchTimes times;
+    times.lex = calloc(options.runs, sizeof(double));
+    times.compile = calloc(options.runs, sizeof(double));
+    times.execute = calloc(options.runs, sizeof(double));
+    times.total = calloc(options.runs, sizeof(double));
+    if (times.lex == NULL || times.compile == NULL || times.execute == NULL || times.total == NULL)
+    {
+        printf("Error. Out of memory.\n");
+        return 1;
+    }
+
+    size_t token_count = 0;
+    size_t instruction_count = 0;
+    for (int run = 0; run < options.runs; run++)
+    {
+        // A fresh directory per run, and nothing remembered about paths from the last one
+        char dir[PATH_MAX];
+        snprintf(dir, sizeof(dir), "%s/path_maker_bench.XXXXXX", options.root);
+        if (mkdtemp(dir) == NULL)
+        {
+            printf("Error. Could not create a directory in %s: %s\n", options.root, strerror(errno));
+            return 1;
+        }
+        cache_forget_paths();
+        PathNode* start = path_from_string(dir);
+        cache_mark_exists(start);
+
+        double began = now();
+        TokenStream tokens = {.type = t_None, .source = source};
+        if (!lex(source, size, &tokens))
+        {
+            return 1;
+        }
+        double lexed = now();
+        Program program = {0};
+        if (!parse_program(&tokens, &program))
+        {
+            return 1;
+        }
+        double compiled = now();
+
+        Executor ex;
+        memset(&ex, 0, sizeof(ex));
+        ex.threads = options.threads;
+        ex.trust_cache = options.trust_cache;
+        ex.batch.root.fd = -1;
+        ex.ring.fd = -1;
+        ex.cwd = start;
+        translate(&program, &ex);
+        flush_makes(&ex);
+        dir_cache_clear(&ex);
+        free_batch(&ex.batch);
+        free(ex.instance.nodes);
+        free(ex.text);
+        double executed = now();
+
+        times.lex[run] = lexed - began;
+        times.compile[run] = compiled - lexed;
+        times.execute[run] = executed - compiled;
+        times.total[run] = executed - began;
+        token_count = tokens.count;
+        instruction_count = program.count;
+        free_program(&program);
+        free_tokens(&tokens);
+        nftw(dir, remove_entry, 64, FTW_DEPTH | FTW_PHYS);
+    }
+
+    FILE* out = options.out != NULL ? fopen(options.out, "w") : stdout;
+    if (out == NULL)
+    {
+        printf("Error writing %s.\n", options.out);
+        return 1;
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "  \"shape\": \"%s\",\n", options.shape);
+    fprintf(out, "  \"size\": %d,\n", options.size);
+    fprintf(out, "  \"depth\": %d,\n", options.depth);
+    fprintf(out, "  \"threads\": %d,\n", options.threads);
+    fprintf(out, "  \"cache\": \"%s\",\n", options.trust_cache ? "trust" : "verify");
+    fprintf(out, "  \"runs\": %d,\n", options.runs);
+    fprintf(out, "  \"root\": \"%s\",\n", options.root);
+    fprintf(out, "  \"bytes\": %zu,\n", size);
+    fprintf(out, "  \"tokens\": %zu,\n", token_count);
+    fprintf(out, "  \"instructions\": %zu,\n", instruction_count);
+    fprintf(out, "  \"seconds\": {\n");
+    write_phase(out, "lex", times.lex, options.runs, false);
+    write_phase(out, "compile", times.compile, options.runs, false);
+    write_phase(out, "execute", times.execute, options.runs, false);
+    write_phase(out, "total", times.total, options.runs, true);
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+    if (out != stdout && fclose(out) != 0)
+    {
+        printf("Error writing %s.\n", options.out);
+        return 1;
+    }
+    free(source);
+    return 0;
+}
+
+
+// Write the script for the chosen shape; false if the shape is unknown
+bool generate_script(FILE* fptr, const BenchOptions* options)
+{
+    bool mixed = !strcmp(options->shape, "mixed");
+    int size = mixed ? (options->size + 3) / 4 : options->size;
+    bool known = mixed;
+    if (mixed || !strcmp(options->shape, "chain"))
+    {
+        generate_chain(fptr, size, options->depth);
+        known = true;
+    }
+    if (mixed || !strcmp(options->shape, "fanout"))
+    {
+        generate_fanout(fptr, size);
+        known = true;
+    }
+    if (mixed || !strcmp(options->shape, "nested"))
+    {
+        generate_nested(fptr, size, options->depth);
+        known = true;
+    }
+    if (mixed || !strcmp(options->shape, "parents"))
+    {
+        generate_parents(fptr, size, options->depth);
+        known = true;
+    }
+    return known;
+}
+
+
+// Chains 'depth' names long, sharing their first half with the chain before
+void generate_chain(FILE* fptr, int size, int depth)
+{
+    for (int i = 0; i < size; i++)
+    {
+        fprintf(fptr, "make <chain%d", i / 2);
+        for (int d = 1; d < depth; d++)
+        {
+            fprintf(fptr, d < depth / 2 ? "/Part%d" : "/Link%d_%d", d, i);
+        }
+        fprintf(fptr, ">;\n");
+    }
+}
+
+
+// Wide directories: one make per directory, spread over a few parents
+void generate_fanout(FILE* fptr, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        fprintf(fptr, "make <wide%d/Entry_%d>;\n", i % 8, i);
+    }
+}
+
+
+// Guards nested 'depth' deep; the inner ones look at paths the outer ones create
+void generate_nested(FILE* fptr, int size, int depth)
+{
+    for (int i = 0; i < size; i++)
+    {
+        fprintf(fptr, "ifnot <guard%d> {\n", i);
+        for (int d = 0; d < depth; d++)
+        {
+            fprintf(fptr, "%*smake <guard%d/level%d>;\n", 2 * d + 2, "", i, d);
+            fprintf(fptr, "%*s%s <guard%d/level%d> {\n", 2 * d + 2, "", d % 2 ? "ifnot" : "if", i, d + d % 2);
+        }
+        fprintf(fptr, "%*smake <guard%d/inner>;\n", 2 * depth + 2, "", i);
+        for (int d = depth; d >= 0; d--)
+        {
+            fprintf(fptr, "%*s}\n", 2 * d, "");
+        }
+    }
+}
+
+
+// Go 'depth' directories down, make a path that climbs back out with '*', and return
+void generate_parents(FILE* fptr, int size, int depth)
+{
+    fprintf(fptr, "make <deep");
+    for (int d = 1; d < depth; d++)
+    {
+        fprintf(fptr, "/down%d", d);
+    }
+    fprintf(fptr, ">;\n");
+    for (int i = 0; i < size; i++)
+    {
+        fprintf(fptr, "go <deep");
+        for (int d = 1; d < depth; d++)
+        {
+            fprintf(fptr, "/down%d", d);
+        }
+        fprintf(fptr, ">;\nmake <");
+        for (int d = 0; d < depth; d++)
+        {
+            fprintf(fptr, "*/");
+        }
+        fprintf(fptr, "up%d>;\ngo <", i);
+        for (int d = 0; d < depth; d++)
+        {
+            fprintf(fptr, d ? "/*" : "*");
+        }
+        fprintf(fptr, ">;\n");
+    }
+}
+
+
+// Monotonic time in seconds
+double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// Order two times, for the median
+int compare_times(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+// Write the minimum, median and mean of one phase's times
+void write_phase(FILE* fptr, const char* name, double* times, int runs, bool last)
+{
+    double sum = 0;
+    for (int i = 0; i < runs; i++)
+    {
+        sum += times[i];
+    }
+    qsort(times, runs, sizeof(double), compare_times);
+    double median = runs % 2 ? times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2;
+    fprintf(fptr, "    \"%s\": {\"min\": %.9f, \"median\": %.9f, \"mean\": %.9f}%s\n",
+            name, times[0], median, sum / runs, last ? "" : ",");
+}
+
+
+// Remove one entry of a run's directory tree (called by nftw, deepest first)
+int remove_entry(const char* path, const struct stat* sb, int flag, struct FTW* ftw)
+{
+    (void)sb;
+    (void)flag;
+    (void)ftw;
+    remove(path);
+    return 0;
+}
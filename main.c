@@ -1,1093 +1,6294 @@
-/*********************************************************************************************************************************************************
-This program implements a basic interpreter for the 'Path_maker' language.
-
-Description of the 'Path_maker' language:
-
-    Data Types: Path is the only data type. Path constants are relative directory path expressions written in the form:
-
-    <dir1/dir2/dir3> where dir1, dir2 and dir3 are directory names.
-     No file names are of any concern (just directories)
-     Directory names start with a letter (upper or lower case) and are made of any combination of letters, digits and underscore characters (only). (Punctuation characters are not allowed. Blank characters are not allowed either.) Directory names are not case sensitive so <AA> and <aa> are basically the same. (since that is the policy of most operating systems)
-     Operator * can be used instead of a directory name, and it indicates parent directory. It can be used multiple times before any other directory name.
-    Example: <'*'/ * /mydirectory> indicates that one should move up (to parent) twice and then choose mydirectory.
-     Operator * can only be used at the beginning of path expressions. <hi/'*'/there> is not allowed.
-     Operator / cannot be used at the beginning or the end of any path. So </hi/there> is not allowed. Neither is <hi/there/> allowed.
-     Blanks in a path expression are ignored (unless they exist in a directory name (which is not allowed)) so < * / * / mydirectory> is OK.
-
-    Variables: There are no variables in the language.
-
-    Basic Commands: The only two basic commands are make and go. Make has the form:
-    make <myDirectoryPath>;
-    It simply creates the directories in the myDirectoryPath. If the path already exists it does nothing (but gives a warning message). If the path partially exists, it completes the path.
-    Example: make <'*'/project1/data> goes up once and then creates a directory called project1 and then creates another one called data inside it.
-    make does not change the current (working) directory. (This is what we do with go command)
-    go simply changes the current directory
-
-    Syntax: go <myPathExpression>;
-    If the path does not exist, go does nothing. (Gives an error message but does not exit the execution) It does not partially follow a path. Partial existence of any path is considered as nonexistence.
-
-    Control Structures: There is an if clause and a similar ifnot clause
-    if <path_expression> command
-    is the basic form of this clause where command can be a basic command or a block. if clause executes the command if from the current directory the path <path_expression> exists.
-    if does not change the current directory.
-    ifnot clause has the exact same structure
-    ifnot <path_expression> command
-    but operates if the path <path_expression> does not exist.
-
-    Blocks: A command can be a basic command (make or go) but it can also be a block. A block is a list of lines of code enclosed in { } set brackets. Blocks may also be nested in one another.
-
-    End of line character: Only make and go commands require an end of line character and it is ; (semi-colon)
-
-    Keywords: Keywords are case sensitive and all are lowercase. They are:
-    make, go, if, ifnot
-
-    Symbols: < , > , { , } , / , *, ;
-***************************************************************************************************************************************************************/
-
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <ctype.h>
-#include <stdbool.h>
-#include <strings.h>
-#include <string.h>
-#include <limits.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <errno.h>
-
-
-// Function prototypes
-char* checkIfKeyWord(char *str);
-char* isbracket(char c);
-bool checkIfAlphaString(char *str);
-char* findTokenType(char *str);
-bool check_path(char* holder3, FILE* fptr3);
-void go(char holder2[], char* cwd, FILE* fptr3);
-void make (char holder2[], char* cwd, FILE* fptr3);
-void ifPath_maker (char holder2[], char* cwd, FILE* fptr3);
-void ifnot (char holder2[], char* cwd, FILE* fptr3);
-void translate(char holder2[], FILE* fptr3, char* cwd);
-
-
-// Max size of string to be read from 'code.lex'
-// Means that length of a line can't be greater than it
-#define BUFF_SIZE 255
-
-
-// Main program logic
-int main(void)
-{
-
-
-    /*
-        Take in file name for the source code file and open
-        it if it exists.
-    */
-
-    // Create character string to hold input
-    // PATH_MAX is OS specific max path length
-    char input[PATH_MAX + 1];
-    printf("Enter file name (without the .pmk extension): ");
-    // Take in input
-    scanf("%s", input);
-    // Concatenate file name with the .pmk extension
-    strcat(input, ".pmk");
-    // Open file in read mode
-    FILE* fptr1 = fopen(input, "r");
-    // Check for errors in opening file
-    if (fptr1 == NULL)
-    {
-        printf("The source code file could not be found/read.\nExiting...\n");
-
-        return 1;
-    }
-
-
-    /*********************************************************************
-     * This subprogram reads in source code for the path_maker language *
-     * and generates tokens to be used by the parser.                   *
-     ********************************************************************/
-    // Create file pointer to access code.lex, the object file to contain the tokens generated
-    FILE* fptr2 = fopen("code.lex", "w");
-    if(fptr2 == NULL)
-    {
-        printf("Error opening code.lex.\nExiting...\n");
-        return 1;
-    }
-
-    // Holds incoming alphanumeric character string from file
-    char holder[PATH_MAX + 1];
-    for(int i = 0; i < PATH_MAX + 1; i++)
-    {
-        holder[i] = '\0';
-    }
-
-    // variables for holding current index values
-    int index = 0;
-
-    // Identifies lexeme(s) in the source code
-    for(char c = fgetc(fptr1); c != EOF; c = fgetc(fptr1))
-    {
-
-        if(c == ';' || c == '*' || c == '/' || isbracket(c) || isspace(c))
-        {
-            // If character string is token, find token type and print it to code.lex file
-            // print form: 'tokenType(lexeme)'
-            if(*holder)
-            {
-                char *tokenType = findTokenType(holder);
-                if(!strcasecmp(tokenType, "t_DirectoryName"))
-                {
-                    for (int i = 0; holder[i] != '\0'; i++)
-                    {
-                        fputc(tolower(holder[i]), fptr2);
-                    }
-                    fputc('\n', fptr2);
-                }
-                else if (!strcasecmp(tokenType, "t_go")
-                         || !strcasecmp(tokenType, "t_make")|| !strcasecmp(tokenType, "t_if")
-                         || !strcasecmp(tokenType, "t_ifnot"))
-                {
-                    fputs(tokenType, fptr2);
-                    fputc('\n', fptr2);
-                }
-                else if(findTokenType(holder) == NULL)
-                {
-                    printf("Error. Unrecognized character: \"%s\" in source file.\nExiting...\n", holder);
-                    return 1;
-                }
-            }
-
-            // Reset index to zero; flush 'holder' array so that it can be used again anew
-            index = 0;
-            for(int i = 0; i < PATH_MAX + 1; i++)
-            {
-                holder[i] = '\0';
-            }
-        }
-        // Check if character is an EOL character
-        if(c == ';')
-        {
-            fputs("t_EndOfLine\n", fptr2);
-            continue;
-        }
-        // Check if character is forward slash
-        if (c == '/')
-        {
-            fputs("t_ForwardSlash\n", fptr2);
-            continue;
-        }
-
-        // Check if character is an astrix
-        if (c == '*')
-        {
-            fputs("t_Astrix\n", fptr2);
-            continue;
-        }
-        // Check if character is a bracket
-        if (isbracket(c) != NULL)
-        {
-            fputs(isbracket(c), fptr2);
-            continue;
-
-        }
-        // If character string length is greater than MAX_LEN print error and exit
-        if(index > PATH_MAX - 1)
-        {
-            printf("Error. Identifier length cannot be greater than %d characters long.\nExiting...\n", PATH_MAX);
-            return 1;
-        }
-        else if(!isspace(c))
-        {
-            holder[index] = c;
-            index++;
-            continue;
-        }
-    }
-
-    fclose(fptr1);
-    fclose(fptr2);
-
-
-    /************************************************
-     * This subprogram is the parser for path_maker *
-     ************************************************/
-
-    // Create a variable that holds the current
-    // (location of this program at execution) directory address
-    char cwd[PATH_MAX];
-    if (getcwd(cwd, sizeof(cwd)) != NULL) printf("Current directory: %s\n", cwd);
-    else
-    {
-        printf("Error getting current directory.\nExiting...\n");
-        return 1;
-    }
-
-    // Read text file containing the lexemes (code.lex)
-    FILE* fptr3 = fopen("code.lex", "r");
-    if (fptr3 == NULL)
-    {
-        printf("Error. 'Code.lex' file could not be read.\nExiting...\n");
-        return 1;
-    }
-
-    // Create a variable to hold incoming strings
-    char holder2[BUFF_SIZE + 1];
-    for(int i = 0; i < BUFF_SIZE + 1; i++)
-    {
-        holder2[i] = '\0';
-    }
-
-    // Check to see if path is legal
-    while(fgets(holder2, BUFF_SIZE, fptr3) != NULL)
-    {
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        if(feof(fptr3))
-        {
-            break;
-        }
-
-        if (!strcasecmp(holder2, "t_LessThanSign"))
-        {
-            if (check_path(holder2, fptr3))
-            {
-                if (!strcasecmp(holder2, "t_GreaterThanSign"));
-                else
-                {
-                    printf("Error. Missing greater than sign after path name: <INVALID_PATH_NAME\n");
-                    return 1;
-                }
-            }
-            else
-            {
-                printf("Error. Less than sign was not followed by a valid path name: <INVALID_PATH_NAME\n");
-            }
-        }
-    }
-    // Take pointer to beginning of file
-    rewind(fptr3);
-    // Translate path_maker commands to C commands and execute
-    translate(holder2, fptr3, cwd);
-    // Close fptr3 to code.lex
-    fclose(fptr3);
-    return 0;
-}
-
-
-// Find token type: path or keyword
-char* findTokenType(char *str)
-{
-    if (checkIfKeyWord(str)!= NULL)
-    {
-        return checkIfKeyWord(str);
-    }
-    bool alphaString_Check = checkIfAlphaString(str);
-    if(alphaString_Check == true)
-    {
-        return "t_DirectoryName";
-    }
-    return NULL;
-}
-
-
-// Check if character string is made up of only ASCII alphabet characters
-bool checkIfAlphaString(char *str)
-{
-    int len = strlen(str);
-    if(isalpha(str[0]))
-    {
-        for(int i = 1; i < len; i++)
-        {
-            if(!isalnum(str[i]) && !(str[i] == '_'))
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-    return false;
-}
-
-
-// Check to see if character is a bracket as defined by path_maker definition
-char* isbracket(char c)
-{
-    if(c == 123)
-    {
-        return "t_LeftCurlyBrace\n";
-    }
-    else if(c == 125)
-    {
-        return "t_RightCurlyBrace\n";
-    }
-    else if(c == 60)
-    {
-        return "t_LessThanSign\n";
-    }
-    else if(c == 62)
-    {
-        return "t_GreaterThanSign\n";
-    }
-    return NULL;
-}
-
-
-// Check if character string is a key word as defined in path_maker
-char* checkIfKeyWord(char *str)
-{
-    if(!strcmp(str, "go"))
-    {
-        return "t_go";
-    }
-    else if (!strcmp(str, "make"))
-    {
-        return "t_make";
-    }
-    else if (!strcmp(str, "if"))
-    {
-        return "t_if";
-    }
-    else if (!strcmp(str, "ifnot"))
-    {
-        return "t_ifnot";
-    }
-    return NULL;
-}
-
-
-// Check a given path's syntactic validity
-bool check_path(char* holder3, FILE* fptr3)
-{
-    fgets(holder3, BUFF_SIZE, fptr3);
-    for(int i = 0; i < BUFF_SIZE + 1; i++)
-    {
-        if (holder3[i] == '\n')
-        {
-            holder3[i] = '\0';
-        }
-    }
-    if(feof(fptr3))
-    {
-        return false;
-    }
-
-    LOOP: if (checkIfAlphaString(holder3) && (strcasecmp(holder3, "t_ForwardSlash") &&
-                                              strcasecmp(holder3, "t_Astrix") &&
-                                              strcasecmp(holder3, "t_LeftCurlyBrace") &&
-                                              strcasecmp(holder3, "t_EndOfLine") &&
-                                              strcasecmp(holder3, "t_if") &&
-                                              strcasecmp(holder3, "t_ifnot") &&
-                                              strcasecmp(holder3, "t_make") &&
-                                              strcasecmp(holder3, "t_go") &&
-                                              strcasecmp(holder3, "t_RightCurlyBrace") &&
-                                              strcasecmp(holder3, "t_LessThanSign") &&
-                                              strcasecmp(holder3, "t_GreaterThanSign")
-                                              ))
-    {
-        fgets(holder3, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder3[i] == '\n')
-            {
-                holder3[i] = '\0';
-            }
-        }
-        if(feof(fptr3))
-        {
-            return false;
-        }
-        if (!strcasecmp(holder3, "t_ForwardSlash"))
-        {
-            fgets(holder3, BUFF_SIZE, fptr3);
-            for(int i = 0; i < BUFF_SIZE + 1; i++)
-            {
-                if (holder3[i] == '\n')
-                {
-                    holder3[i] = '\0';
-                }
-            }
-            if (!strcasecmp(holder3, "t_Astrix"))
-            {
-                return false;
-            }
-            goto LOOP;
-        }
-        return true;
-    }
-
-    if (!strcasecmp(holder3, "t_Astrix"))
-    {
-        fgets(holder3, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder3[i] == '\n')
-            {
-                holder3[i] = '\0';
-            }
-        }
-        if(feof(fptr3))
-        {
-            return false;
-        }
-        if (!strcasecmp(holder3, "t_ForwardSlash"))
-        {
-            check_path(holder3, fptr3);
-        }
-        return true;
-    }
-    return false;
-}
-
-
-// Translate path_maker commands to C command
-void translate(char holder2[], FILE* fptr3, char* cwd)
-{
-    while(fgets(holder2, BUFF_SIZE, fptr3) != NULL)
-    {
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        if (feof(fptr3)) break;
-        if (!strcasecmp(holder2, "t_go"))
-        {
-            go(holder2, cwd, fptr3);
-        }
-        if (!strcasecmp(holder2, "t_make"))
-        {
-            make(holder2, cwd, fptr3);
-        }
-        if (!strcasecmp(holder2, "t_if"))
-        {
-            ifPath_maker(holder2, cwd, fptr3);
-        }
-        if (!strcasecmp(holder2, "t_ifnot"))
-        {
-            ifnot(holder2, cwd, fptr3);
-        }
-    }
-
-
-}
-
-
-// Translate path_maker go command to C command
-void go(char holder2[], char* cwd, FILE* fptr3)
-{
-
-    char cwd2[PATH_MAX];
-    for(int i = 0; i < PATH_MAX; i++)
-    {
-        cwd2[i] = '\0';
-    }
-    strcpy(cwd2, cwd);
-    fgets(holder2, BUFF_SIZE, fptr3);
-    for(int i = 0; i < BUFF_SIZE + 1; i++)
-    {
-        if (holder2[i] == '\n')
-        {
-            holder2[i] = '\0';
-        }
-    }
-    if (!strcasecmp(holder2, "t_LessThanSign"))
-    {
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        char folder[PATH_MAX];
-        for(int i = 0; i < PATH_MAX; i++)
-        {
-            folder[i] = '\0';
-        }
-        while (strcasecmp(holder2, "t_GreaterThanSign"))
-        {
-            if (!strcasecmp(holder2, "t_Astrix"))
-            {
-                for(int i = PATH_MAX - 1; i >= 0; i--)
-                {
-                    if (cwd[i] != '\\')
-                    {
-                         cwd[i] = '\0';
-                    }
-                    else
-                    {
-                        cwd[i] = '\0';
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                fgets(holder2, BUFF_SIZE, fptr3);
-                for(int i = 0; i < BUFF_SIZE + 1; i++)
-                {
-                    if (holder2[i] == '\n')
-                    {
-                        holder2[i] = '\0';
-                    }
-                }
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                     fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                }
-            }
-            else if (strcasecmp(holder2, "t_GreaterThanSign"))
-            {
-
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                while (true)
-                {
-                    if(strcmp(holder2, ""))
-                    {
-                        strcat(folder, "\\");
-                    }
-                    strcat(folder, holder2);
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_ForwardSlash")) strcpy(holder2, "");
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-            }
-        }
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        if (strcasecmp(holder2, "t_EndOfLine"))
-        {
-            printf("Error. 'go' statement was not followed by a semicolon. Exiting...\n");
-            exit(0);
-        }
-        struct stat sb;
-        if (stat(folder, &sb) == 0 && S_ISDIR(sb.st_mode)) {
-            printf("Path exists. Go statement executed.\n");
-            strcpy(cwd, folder);
-            printf("Current directory is now changed to: %s\n", cwd);
-        } else {
-            printf("Path: %s does not exist. Go statement cannot be executed\n", folder);
-            strcpy(cwd, cwd2);
-        }
-    }
-    else
-    {
-        printf("Error. 'go' statement should be followed by a path name: '<PATH_NAME>'.\n");
-        exit(0);
-    }
-}
-
-
-// Translate path_maker make command to C command
-void make(char holder2[], char* cwd, FILE* fptr3)
-{
-    fgets(holder2, BUFF_SIZE, fptr3);
-    for(int i = 0; i < BUFF_SIZE + 1; i++)
-    {
-        if (holder2[i] == '\n')
-        {
-            holder2[i] = '\0';
-        }
-    }
-    if (!strcasecmp(holder2, "t_LessThanSign"))
-    {
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        char folder[PATH_MAX];
-        for(int i = 0; i < PATH_MAX; i++)
-        {
-            folder[i] = '\0';
-        }
-        while (strcasecmp(holder2, "t_GreaterThanSign"))
-        {
-            if (!strcasecmp(holder2, "t_Astrix"))
-            {
-                for(int i = PATH_MAX - 1; i >= 0; i--)
-                {
-                    if (cwd[i] != '\\')
-                    {
-                         cwd[i] = '\0';
-                    }
-                    else
-                    {
-                        cwd[i] = '\0';
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                fgets(holder2, BUFF_SIZE, fptr3);
-                for(int i = 0; i < BUFF_SIZE + 1; i++)
-                {
-                    if (holder2[i] == '\n')
-                    {
-                        holder2[i] = '\0';
-                    }
-                }
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                     fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                }
-            }
-            else if (strcasecmp(holder2, "t_GreaterThanSign"))
-            {
-
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                while (true)
-                {
-                    if(strcmp(holder2, ""))
-                    {
-                        strcat(folder, "\\");
-                    }
-                    strcat(folder, holder2);
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_ForwardSlash")) strcpy(holder2, "");
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-            }
-        }
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        if (strcasecmp(holder2, "t_EndOfLine"))
-        {
-            printf("Error. 'make' statement was not followed by a semicolon. Exiting...\n");
-            exit(0);
-        }
-        struct stat sb;
-        if (stat(folder, &sb) == 0 && S_ISDIR(sb.st_mode)) {
-            printf("Path already exists. Make statement will not be executed.\n");
-        } else {
-            char* mkcmd[PATH_MAX];
-            for(int i = 0; i < BUFF_SIZE + 1; i++)
-            {
-               mkcmd[i] = '\0';
-            }
-            sprintf(mkcmd, "mkdir -p %s", folder);
-            system(mkcmd);
-            printf("Success. Path: \'%s\' created with make command.\n", folder);
-        }
-    }
-    else
-    {
-        printf("Error. 'make' statement should be followed by a path name: '<PATH_NAME>'.\n");
-        exit(0);
-    }
-}
-
-
-// Translate path_maker if to C if
-void ifPath_maker(char holder2[], char* cwd, FILE* fptr3)
-{
-    char cwd2[PATH_MAX];
-    for(int i = 0; i < PATH_MAX; i++)
-    {
-        cwd2[i] = '\0';
-    }
-    strcpy(cwd2, cwd);
-    fgets(holder2, BUFF_SIZE, fptr3);
-    for(int i = 0; i < BUFF_SIZE + 1; i++)
-    {
-        if (holder2[i] == '\n')
-        {
-            holder2[i] = '\0';
-        }
-    }
-    if (!strcasecmp(holder2, "t_LessThanSign"))
-    {
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        char folder[PATH_MAX];
-        for(int i = 0; i < PATH_MAX; i++)
-        {
-            folder[i] = '\0';
-        }
-        while (strcasecmp(holder2, "t_GreaterThanSign"))
-        {
-            if (!strcasecmp(holder2, "t_Astrix"))
-            {
-                for(int i = PATH_MAX - 1; i >= 0; i--)
-                {
-                    if (cwd[i] != '\\')
-                    {
-                         cwd[i] = '\0';
-                    }
-                    else
-                    {
-                        cwd[i] = '\0';
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                fgets(holder2, BUFF_SIZE, fptr3);
-                for(int i = 0; i < BUFF_SIZE + 1; i++)
-                {
-                    if (holder2[i] == '\n')
-                    {
-                        holder2[i] = '\0';
-                    }
-                }
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                     fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                }
-            }
-            else if (strcasecmp(holder2, "t_GreaterThanSign"))
-            {
-
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                while (true)
-                {
-                    if(strcmp(holder2, ""))
-                    {
-                        strcat(folder, "\\");
-                    }
-                    strcat(folder, holder2);
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_ForwardSlash")) strcpy(holder2, "");
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-            }
-        }
-        struct stat sb;
-        if (stat(folder, &sb) == 0 && S_ISDIR(sb.st_mode)) {
-            printf("Path exists. If statement will be executed.\n");
-            fgets(holder2, BUFF_SIZE, fptr3);
-            for(int i = 0; i < BUFF_SIZE + 1; i++)
-            {
-                if (holder2[i] == '\n')
-                {
-                    holder2[i] = '\0';
-                }
-            }
-            if (feof(fptr3)) {
-                printf("Error. End of file reached without a command completing.\n");
-                exit(0);}
-            if (!strcasecmp(holder2, "t_go"))
-            {
-                go(holder2, cwd, fptr3);
-            }
-            else if (!strcasecmp(holder2, "t_make"))
-            {
-                make(holder2, cwd, fptr3);
-            }
-            if (!strcasecmp(holder2, "t_LeftCurlyBrace"))
-            {
-                translate(holder2, fptr3, cwd);
-                if (!(strcasecmp(holder2, "t_RightCurlyBrace")));
-                else printf("Error. Left curly brace not closed with a right curly brace.\n");
-            }
-
-
-        } else {
-            printf("Path: %s does not exist. Command following if clause will not be executed.\n", folder);
-            while (fgets(holder2, BUFF_SIZE, fptr3) != NULL){
-            for(int i = 0; i < BUFF_SIZE + 1; i++){
-                if (holder2[i] == '\n')
-                {
-                    holder2[i] = '\0';
-                }
-            }
-            if (feof(fptr3)) {
-                printf("Error. End of file reached without a command completing.\n");
-                exit(0);}
-            if (!(strcasecmp(holder2, "t_RightCurlyBrace"))) break;
-        }
-        }
-    }
-    else
-    {
-        printf("Error. 'if' statement should be followed by a path name: '<PATH_NAME>'.\n");
-        exit(0);
-    }
-}
-
-
-// Translate path_maker ifnot to C if(!expression)
-void ifnot(char holder2[], char* cwd, FILE* fptr3)
-{
-    char cwd2[PATH_MAX];
-    for(int i = 0; i < PATH_MAX; i++)
-    {
-        cwd2[i] = '\0';
-    }
-    strcpy(cwd2, cwd);
-    fgets(holder2, BUFF_SIZE, fptr3);
-    for(int i = 0; i < BUFF_SIZE + 1; i++)
-    {
-        if (holder2[i] == '\n')
-        {
-            holder2[i] = '\0';
-        }
-    }
-    if (!strcasecmp(holder2, "t_LessThanSign"))
-    {
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        char folder[PATH_MAX];
-        for(int i = 0; i < PATH_MAX; i++)
-        {
-            folder[i] = '\0';
-        }
-        while (strcasecmp(holder2, "t_GreaterThanSign"))
-        {
-            if (!strcasecmp(holder2, "t_Astrix"))
-            {
-                for(int i = PATH_MAX - 1; i >= 0; i--)
-                {
-                    if (cwd[i] != '\\')
-                    {
-                         cwd[i] = '\0';
-                    }
-                    else
-                    {
-                        cwd[i] = '\0';
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                fgets(holder2, BUFF_SIZE, fptr3);
-                for(int i = 0; i < BUFF_SIZE + 1; i++)
-                {
-                    if (holder2[i] == '\n')
-                    {
-                        holder2[i] = '\0';
-                    }
-                }
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                     fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                }
-            }
-            else if (strcasecmp(holder2, "t_GreaterThanSign"))
-            {
-
-                if (!strcasecmp(holder2, "t_ForwardSlash"))
-                {
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-                strcpy(folder, cwd);
-                while (true)
-                {
-                    if(strcmp(holder2, ""))
-                    {
-                        strcat(folder, "\\");
-                    }
-                    strcat(folder, holder2);
-                    fgets(holder2, BUFF_SIZE, fptr3);
-                    for(int i = 0; i < BUFF_SIZE + 1; i++)
-                    {
-                        if (holder2[i] == '\n')
-                        {
-                            holder2[i] = '\0';
-                        }
-                    }
-                    if (!strcasecmp(holder2, "t_ForwardSlash")) strcpy(holder2, "");
-                    if (!strcasecmp(holder2, "t_GreaterThanSign"))
-                    {
-                        break;
-                    }
-                }
-            }
-        }
-        struct stat sb;
-        if (stat(folder, &sb) == 0 && S_ISDIR(sb.st_mode)) {
-            printf("Path exists. Ifnot command will not be executed.\n");
-            while (fgets(holder2, BUFF_SIZE, fptr3) != NULL){
-            for(int i = 0; i < BUFF_SIZE + 1; i++){
-                if (holder2[i] == '\n')
-                {
-                    holder2[i] = '\0';
-                }
-            }
-            if (feof(fptr3)) {
-                printf("Error. End of file reached without a command completing.\n");
-                exit(0);}
-            if (!(strcasecmp(holder2, "t_RightCurlyBrace"))) break;
-        }
-        }
-        else {
-        printf("Path: %s does not exist. Command following ifnot clause will execute.\n", folder);
-        fgets(holder2, BUFF_SIZE, fptr3);
-        for(int i = 0; i < BUFF_SIZE + 1; i++)
-        {
-            if (holder2[i] == '\n')
-            {
-                holder2[i] = '\0';
-            }
-        }
-        if (feof(fptr3)) {
-            printf("Error. End of file reached with a command completing.\n");
-            exit(0);}
-        if (!strcasecmp(holder2, "t_go"))
-        {
-            go(holder2, cwd, fptr3);
-        }
-        else if (!strcasecmp(holder2, "t_make"))
-        {
-            make(holder2, cwd, fptr3);
-        }
-        if (!strcasecmp(holder2, "t_LeftCurlyBrace"))
-        {
-            translate(holder2, fptr3, cwd);
-            if (!(strcasecmp(holder2, "t_RightCurlyBrace")));
-            else printf("Error. Left curly brace not closed with a right curly brace.\n");
-        }
-        }
-    }
-    else
-    {
-        printf("Error. 'if' statement should be followed by a path name: '<PATH_NAME>'.\n");
-        exit(0);
-    }
-}
+/*********************************************************************************************************************************************************
+This program implements a basic interpreter for the 'Path_maker' language.
+
+Description of the 'Path_maker' language:
+
+    Data Types: Path is the only data type. Path constants are relative directory path expressions written in the form:
+
+    <dir1/dir2/dir3> where dir1, dir2 and dir3 are directory names.
+     No file names are of any concern (just directories)
+     Directory names start with a letter (upper or lower case) and are made of any combination of letters, digits and underscore characters (only). (Punctuation characters are not allowed. Blank characters are not allowed either.) Directory names are not case sensitive so <AA> and <aa> are basically the same. (since that is the policy of most operating systems)
+     Operator * can be used instead of a directory name, and it indicates parent directory. It can be used multiple times before any other directory name.
+    Example: <'*'/ * /mydirectory> indicates that one should move up (to parent) twice and then choose mydirectory.
+     Operator * can only be used at the beginning of path expressions. <hi/'*'/there> is not allowed.
+     Operator / cannot be used at the beginning or the end of any path. So </hi/there> is not allowed. Neither is <hi/there/> allowed.
+     Blanks in a path expression are ignored (unless they exist in a directory name (which is not allowed)) so < * / * / mydirectory> is OK.
+
+    Variables: There are no variables in the language.
+
+    Basic Commands: The only two basic commands are make and go. Make has the form:
+    make <myDirectoryPath>;
+    It simply creates the directories in the myDirectoryPath. If the path already exists it does nothing (but gives a warning message). If the path partially exists, it completes the path.
+    Example: make <'*'/project1/data> goes up once and then creates a directory called project1 and then creates another one called data inside it.
+    make does not change the current (working) directory. (This is what we do with go command)
+    go simply changes the current directory
+
+    Syntax: go <myPathExpression>;
+    If the path does not exist, go does nothing. (Gives an error message but does not exit the execution) It does not partially follow a path. Partial existence of any path is considered as nonexistence.
+
+    Control Structures: There is an if clause and a similar ifnot clause
+    if <path_expression> command
+    is the basic form of this clause where command can be a basic command or a block. if clause executes the command if from the current directory the path <path_expression> exists.
+    if does not change the current directory.
+    ifnot clause has the exact same structure
+    ifnot <path_expression> command
+    but operates if the path <path_expression> does not exist.
+
+    Blocks: A command can be a basic command (make or go) but it can also be a block. A block is a list of lines of code enclosed in { } set brackets. Blocks may also be nested in one another.
+
+    End of line character: Only make and go commands require an end of line character and it is ; (semi-colon)
+
+    Loops: A repeat clause runs a command (a basic command or a block) a given number of times
+    repeat N as i command
+    where N is a number and i is the loop variable. It counts from 0 to N - 1 and can be used inside the command in directory names, written
+    in square brackets right after the start of a name: repeat 3 as i make <shard[i]/data>; makes shard0/data, shard1/data and shard2/data.
+    Loops may be nested, each with its own variable. The command is compiled once, however many times it runs.
+
+    Templates: A template is a set of make statements defined once, outside of any block or loop, and used under any number of directories
+    define project { make <src/main>; make <src/test>; make <doc>; }
+    use project at <tenants/acme>;
+    The paths of a template are relative to where it is used and can only contain directory names. Its make statements are planned into one
+    subtree when the script is compiled, and each use makes that subtree under its path. A template must be defined before it is used.
+
+    Keywords: Keywords are case sensitive and all are lowercase. They are:
+    make, go, if, ifnot, repeat, define, use (and as right after the count of a repeat, at right after the template of a use)
+
+    Symbols: < , > , { , } , [ , ] , / , *, ;
+***************************************************************************************************************************************************************/
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include <time.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+#ifndef O_PATH
+// Directories opened only to run system calls relative to them
+#define O_PATH 0
+#endif
+
+
+// Token types generated by the lexer
+// t_None is zero so that 'isbracket' and 'findTokenType' results can be tested as booleans
+typedef enum
+{
+    t_None,
+    t_go,
+    t_make,
+    t_if,
+    t_ifnot,
+    t_repeat,
+    t_define,
+    t_use,
+    t_DirectoryName,
+    t_EndOfLine,
+    t_ForwardSlash,
+    t_Astrix,
+    t_LeftCurlyBrace,
+    t_RightCurlyBrace,
+    t_LessThanSign,
+    t_GreaterThanSign,
+    t_Comma,
+    t_LeftSquareBracket,
+    t_RightSquareBracket,
+    t_Range,
+    t_Number
+} TokenType;
+
+// Token type names as written to 'code.lex', indexed by TokenType
+const char* const tokenNames[] =
+{
+    "t_None",
+    "t_go",
+    "t_make",
+    "t_if",
+    "t_ifnot",
+    "t_repeat",
+    "t_define",
+    "t_use",
+    "t_DirectoryName",
+    "t_EndOfLine",
+    "t_ForwardSlash",
+    "t_Astrix",
+    "t_LeftCurlyBrace",
+    "t_RightCurlyBrace",
+    "t_LessThanSign",
+    "t_GreaterThanSign",
+    "t_Comma",
+    "t_LeftSquareBracket",
+    "t_RightSquareBracket",
+    "t_Range",
+    "t_Number"
+};
+
+// A single token generated by the lexer
+typedef struct
+{
+    TokenType type;
+    // Interned, lowercased name of 't_DirectoryName' tokens
+    uint32_t atom;
+    // Slice of the source text the token was read from
+    uint32_t offset;
+    uint32_t length;
+} Token;
+
+// Deepest nesting of repeat loops
+#define LOOP_DEPTH 16
+
+// Contiguous array of tokens read directly by the parser
+typedef struct
+{
+    Token* tokens;
+    size_t count;
+    size_t capacity;
+    // Index of the next token to be read by the parser
+    size_t pos;
+    // Type and text (lexeme or token type name) of the last token read
+    TokenType type;
+    const char* current;
+    // Source text the token slices point into
+    const char* source;
+    // Variables of the repeat loops around the statement being parsed, outermost first
+    uint32_t loop_names[LOOP_DEPTH];
+    uint32_t loop_depth;
+    // Directories of the template being parsed, hashed by parent and name: each slot holds a
+    // template node index + 1, and the entries of earlier templates count as empty
+    uint32_t* template_table;
+    size_t template_table_size;
+} TokenStream;
+
+// Contents of a source file, memory-mapped when possible
+typedef struct
+{
+    const char* data;
+    size_t size;
+    bool mapped;
+} Source;
+
+// Classes of up to 32 consecutive bytes of source, one bit per byte
+typedef struct
+{
+    // Spaces, tabs and line breaks
+    uint32_t blank;
+    // Bytes that continue an identifier: anything but blanks and symbols ('.' counts as a symbol)
+    uint32_t word;
+    // Letters, digits and '_', the only characters of a directory name
+    uint32_t name;
+} ByteClasses;
+
+// Part of a large source lexed by one thread. Its names are numbered in order of first use
+// within the part, and replaced by their atoms once every part has been lexed.
+typedef struct
+{
+    const char* text;
+    size_t begin;
+    size_t end;
+    TokenStream tokens;
+    // Token index of the first use of each name, and a hash table of the names (number + 1)
+    uint32_t* names;
+    uint32_t name_count;
+    uint32_t name_capacity;
+    uint32_t* table;
+    size_t table_size;
+    // Atom of each name, in the same order
+    uint32_t* atoms;
+    // Where the part's tokens go in the token array of the whole source
+    Token* out;
+    bool valid;
+} LexChunk;
+
+// Instructions of a compiled program, one per statement
+typedef enum
+{
+    op_go,
+    op_make,
+    op_if,
+    op_ifnot,
+    // A make whose path has brace or range expansions: one make per expanded path
+    op_expand,
+    // Start of a repeat loop, whose body runs up to its 'end'; and the last instruction
+    // of the body, which jumps back to its first instruction ('end') until the loop is done
+    op_repeat,
+    op_next,
+    // A use statement: the subtree of a template, made under a path
+    op_use
+} OpCode;
+
+// A parsed path expression: '*' operators followed by directory names
+typedef struct
+{
+    // Number of leading '*' (parent directory) operators
+    uint32_t parents;
+    // Directory names: 'count' entries of the program's name array, from 'first', or of its
+    // part array when 'parts' is set (for names with expansions or loop indexes)
+    uint32_t count;
+    uint32_t first;
+    uint32_t parts;
+} PathExpr;
+
+// Kinds of the parts of an expanding path
+typedef enum
+{
+    // A directory name: the name at 'first'
+    part_name,
+    // '{a,b,c}': each of the names from 'first' up to 'last'
+    part_choice,
+    // '[lo..hi]': each number from 'first' to 'last', zero-padded to 'width' digits
+    part_range,
+    // '[i]': the index of the repeat loop at nesting level 'first' (0 for the outermost)
+    part_index
+} PartKind;
+
+// One part of a path with expansions. A directory name of such a path is made of one
+// or more adjacent parts, as in 'shard[0..9]', 'x{a,b}y' or 'tenant[i]'; such a path
+// refers to 'count' parts from 'first' instead of to names. Fixed width, and stored
+// as is in compiled (.pmc) files.
+typedef struct
+{
+    // A PartKind
+    uint16_t kind;
+    // Set when the part continues the directory name of the part before it
+    uint16_t joined;
+    // Indexes into the program's name array, or the bounds of a range
+    uint32_t first;
+    uint32_t last;
+    uint32_t width;
+} PathPart;
+
+// Parent of the directories at the top of a template's subtree
+#define TEMPLATE_ROOT UINT32_MAX
+
+// A directory of a template's subtree, relative to where the template is used; fixed
+// width, and stored as is in compiled (.pmc) files
+typedef struct
+{
+    // Index of the parent among the template's nodes (always an earlier one), or TEMPLATE_ROOT
+    uint32_t parent;
+    // Index into the program's name array
+    uint32_t name;
+    // Set when no other directory of the subtree is below this one: the subtree's make targets
+    uint32_t leaf;
+} TemplateNode;
+
+// A template, 'define NAME { make <PATH>; ... }', as the subtree its make statements create
+typedef struct
+{
+    // Index of the template's name in the program's name array
+    uint32_t name;
+    // 'count' entries of the program's template node array, from 'first', parents first
+    uint32_t first;
+    uint32_t count;
+} Template;
+
+// One instruction of the program built by the parser; fixed width, and stored
+// as is in compiled (.pmc) files
+typedef struct
+{
+    // An OpCode
+    uint32_t op;
+    // Index of the first instruction after the command of an 'if'/'ifnot', i.e. past
+    // its closing brace: a false condition jumps straight there. Likewise past the body
+    // of an op_repeat, the start of the body for an op_next, and the index of the
+    // template of an op_use.
+    uint32_t end;
+    union
+    {
+        // Path operand of every instruction but op_repeat and op_next
+        PathExpr path;
+        // Number of runs of a loop's body, and the loop's nesting level (0 for the outermost)
+        struct
+        {
+            uint32_t times;
+            uint32_t level;
+        } loop;
+    };
+} Instruction;
+
+// A whole script as a flat instruction array; the command of an 'if'/'ifnot'
+// is the run of instructions that follows it, up to its 'end'
+typedef struct
+{
+    Instruction* code;
+    size_t count;
+    size_t capacity;
+    // Directory names of every path, one after the other: atoms, or for a program
+    // loaded from a .pmc file, indexes into that file's string table
+    uint32_t* names;
+    size_t name_count;
+    size_t name_capacity;
+    // Parts of the paths with expansions or loop indexes
+    PathPart* parts;
+    size_t part_count;
+    size_t part_capacity;
+    // Templates, and the directories of their subtrees
+    Template* templates;
+    size_t template_count;
+    size_t template_capacity;
+    TemplateNode* template_nodes;
+    size_t template_node_count;
+    size_t template_node_capacity;
+    // Atom of each string of a loaded .pmc file (NULL for programs compiled here)
+    uint32_t* atoms;
+    // The mapped .pmc file that the arrays above point into
+    void* mapping;
+    size_t mapping_size;
+} Program;
+
+// Header of a compiled (.pmc) file, followed by the instructions, the name array,
+// the part array, the templates and their nodes, 'string_count + 1' string offsets and
+// the string bytes; all in host byte order
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t instruction_count;
+    uint32_t name_count;
+    uint32_t part_count;
+    uint32_t template_count;
+    uint32_t template_node_count;
+    uint32_t string_count;
+    uint32_t string_bytes;
+} PmcHeader;
+
+// A block of arena memory; its bytes follow this header
+typedef struct ArenaBlock
+{
+    struct ArenaBlock* next;
+    size_t size;
+} ArenaBlock;
+
+// Bump allocator: memory is handed out in order from large blocks, is not zeroed, and is
+// only given back all at once. A reset arena keeps its blocks and fills them again.
+typedef struct
+{
+    ArenaBlock* first;
+    // Block being filled (NULL before the first one) and the bytes of it already used
+    ArenaBlock* current;
+    size_t used;
+} Arena;
+
+// An interned directory name
+typedef struct
+{
+    char* name;
+    size_t len;
+} Atom;
+
+// Atoms are stored in chunks of 2^ATOM_CHUNK_BITS that never move, so names
+// can be read without a lock while other scripts intern new ones
+#define ATOM_CHUNK_BITS 16
+
+// Table of every distinct directory name; each is stored once and known by its index
+typedef struct
+{
+    Atom* chunks[1 << ATOM_CHUNK_BITS];
+    uint32_t count;
+    // Open-addressing hash table of atom index + 1 (0 marks an empty slot)
+    uint32_t* table;
+    size_t size;
+    // The names' characters
+    Arena text;
+} Interner;
+
+// What is known about whether a path exists; the states from PATH_DIRECTORY on are directories
+typedef enum
+{
+    PATH_UNKNOWN,
+    PATH_MISSING,
+    PATH_DIRECTORY,
+    // Made by this process
+    PATH_CREATED
+} PathState;
+
+// A resolved absolute path: one node per directory in a trie shared by everything
+// that handles paths, so a path is identified by its node pointer
+typedef struct PathNode
+{
+    // The root is its own parent
+    struct PathNode* parent;
+    uint32_t atom;
+    // Number of names from the root down to this directory
+    uint32_t depth;
+    // Length of the absolute path string
+    size_t len;
+    // Existence cache entry for this path, shared by scripts running in parallel
+    _Atomic PathState state;
+    // Planner marks: subdirectories read from disk; planned make target; implied by a deeper target;
+    // created by the simulation only
+    bool scanned;
+    bool planned;
+    bool covered;
+    bool simulated;
+    // '--reconcile' marks: WANTED_TARGET and/or WANTED_ABOVE
+    uint8_t wanted;
+    // This directory's node in the pending make batch, if it is queued
+    struct BatchNode* batch;
+} PathNode;
+
+// Trie of resolved paths, with children found by hashing (parent, atom)
+typedef struct
+{
+    // The filesystem root '/'
+    PathNode root;
+    PathNode** table;
+    size_t size;
+    size_t count;
+    // Every other node; nodes are never freed, so the trie can be read without a lock
+    Arena nodes;
+} PathTrie;
+
+// A directory queued for creation by the parallel make engine
+typedef struct BatchNode
+{
+    struct BatchNode* parent;
+    // First child and next sibling in the tree of queued directories
+    struct BatchNode* child;
+    struct BatchNode* sibling;
+    PathNode* path;
+    // Index of the first make statement in the batch that needs this directory
+    int owner;
+    int children;
+    // Children not yet processed; the last one to finish closes 'fd'
+    atomic_int pending;
+    // Open directory fd (O_PATH) while children are being created, -1 otherwise
+    int fd;
+    // Known to exist when queued: the top of a subtree, opened but not made
+    bool base;
+    bool created;
+    // errno if this directory (or one of its parents) could not be created
+    int error;
+} BatchNode;
+
+// A make statement waiting in the batch
+typedef struct
+{
+    PathNode* target;
+    BatchNode* leaf;
+    // Journal hash of the statement, recorded once its directory exists
+    uint64_t key;
+} BatchStatement;
+
+// Make statements collected since the last go/if/ifnot, as a tree of directories
+typedef struct
+{
+    // Parent of the subtrees' bases; it stands for no directory and is never opened
+    BatchNode root;
+    // Every queued directory, in the order it was added
+    BatchNode** list;
+    size_t nodes;
+    size_t list_capacity;
+    BatchStatement* statements;
+    int count;
+    int capacity;
+    // The queued directories' nodes and the backends' working memory, emptied with the batch;
+    // the arena and the arrays above are kept from one batch to the next
+    Arena arena;
+} MakeBatch;
+
+// Task deque of one worker: the owner takes from the tail, thieves from the head
+typedef struct
+{
+    pthread_mutex_t lock;
+    BatchNode** tasks;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+} WorkDeque;
+
+// Work-stealing pool creating the directories of one batch
+typedef struct
+{
+    WorkDeque* deques;
+    int workers;
+    // Tasks queued or running; workers stop when it drops to zero
+    atomic_long outstanding;
+    // Tasks waiting in the deques, and workers parked on 'ready' until there are some
+    atomic_long queued;
+    atomic_int sleeping;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t ready;
+} WorkPool;
+
+typedef struct
+{
+    WorkPool* pool;
+    int index;
+} WorkerArg;
+
+// Submission and completion rings of an io_uring instance; fd is -1 when not in use
+typedef struct
+{
+    int fd;
+    void* ring_ptr;
+    size_t ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned* sq_tail;
+    unsigned* sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+} Uring;
+
+#ifdef __linux__
+// Operations submitted through the ring
+typedef enum
+{
+    uop_mkdir,
+    uop_open,
+    uop_statx
+} UringKind;
+
+// One operation on a name in an open directory
+typedef struct
+{
+    int dirfd;
+    const char* path;
+    UringKind kind;
+    // 0 or the opened fd once completed, or -errno; -ECANCELED until then
+    int result;
+    struct statx stx;
+} UringOp;
+#endif
+
+// Statement results keyed by statement hash; a key of 0 marks an empty slot
+typedef struct
+{
+    uint64_t* keys;
+    char* results;
+    size_t size;
+    size_t count;
+} JournalTable;
+
+// '--journal': what the statements of the last run found ('D' a directory, 'M' missing),
+// and what those of this run find, written back over it at exit
+typedef struct
+{
+    JournalTable previous;
+    JournalTable current;
+    char filename[PATH_MAX];
+} Journal;
+
+// An if/ifnot whose command is running: the instructions after 'start' and before 'end'
+// run under it, and their journal hashes include its hash
+typedef struct
+{
+    uint32_t start;
+    uint32_t end;
+    uint64_t key;
+} JournalGuard;
+
+// A growing list of path nodes
+typedef struct
+{
+    PathNode** nodes;
+    size_t count;
+    size_t capacity;
+} NodeList;
+
+// Directories kept open by an executor; a path's slot is its depth modulo this
+#define DIR_CACHE_DEPTH 64
+
+// Execution state of a running script
+typedef struct
+{
+    // Program being run, and current directory
+    const Program* program;
+    PathNode* cwd;
+    // Number of threads creating directories; 1 runs every make immediately
+    int threads;
+    MakeBatch batch;
+    // Ring used to create queued directories when '--io-uring' is given and available
+    Uring ring;
+    // Statement results of the previous run and of this one ('--journal'); NULL when not kept
+    Journal* journal;
+    // The instruction being run, and the if/ifnot statements whose command it is part of,
+    // innermost last; 'condition' is the journal hash of the last go/if/ifnot
+    const Instruction* statement;
+    JournalGuard* guards;
+    size_t guard_count;
+    size_t guard_capacity;
+    uint64_t condition;
+    // Answer from the cache for paths this process made or looked at ('--cache trust'), or always stat ('--cache verify')
+    bool trust_cache;
+    // Where statement messages are written; NULL discards them
+    FILE* out;
+    // Open directories of recently used paths, one per depth (modulo DIR_CACHE_DEPTH), so that
+    // system calls name one component relative to its parent; closed when a script finishes
+    PathNode* dir_nodes[DIR_CACHE_DEPTH];
+    int dir_fds[DIR_CACHE_DEPTH];
+    // Index of each running repeat loop, by nesting level
+    uint32_t loop[LOOP_DEPTH];
+    // Nodes of the directories of the template being used, by their index in it
+    NodeList instance;
+    // Path string of the statement being run, grown to fit
+    char* text;
+    size_t text_size;
+    // Simulate the script and collect make targets instead of touching the filesystem ('--plan')
+    bool planning;
+    NodeList plan;
+    size_t planned_directories;
+    // '--reconcile': every make target, and every real directory found by reading its parent
+    bool reconciling;
+    NodeList targets;
+    NodeList found;
+} Executor;
+
+// Script files named on the command line, in the order they run
+typedef struct
+{
+    char** names;
+    size_t count;
+    size_t capacity;
+} ScriptList;
+
+// Scripts shared by the threads of '-j N', each taking the next one not yet started
+typedef struct
+{
+    ScriptList* scripts;
+    atomic_size_t next;
+    atomic_int failed;
+    PathNode* start;
+    bool trust_cache;
+    bool dump_lex;
+} ScriptQueue;
+
+// A compiled script kept by the server between requests, keyed by file path
+// (valid while the file is unchanged) or by the submitted source text itself
+typedef struct CachedScript
+{
+    struct CachedScript* next;
+    char* key;
+    size_t key_len;
+    size_t hash;
+    bool is_file;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    Program program;
+    // Requests running it; a replaced script is freed when the last one finishes
+    int users;
+    bool stale;
+} CachedScript;
+
+// State of '--serve': the listening socket and the compiled scripts
+typedef struct
+{
+    int fd;
+    PathNode* start;
+    pthread_mutex_t lock;
+    // Most recently used first
+    CachedScript* scripts;
+    size_t count;
+} Server;
+
+// A connection being served by its own thread
+typedef struct
+{
+    Server* server;
+    int fd;
+} ServerClient;
+
+// Counters and phase times reported by '--stats', updated from every thread
+typedef struct
+{
+    atomic_ulong tokens;
+    // Instructions compiled, and instructions executed (a skipped command is not executed)
+    atomic_ulong statements;
+    atomic_ulong executed;
+    // stat/fstatat/statx and mkdir/mkdirat calls, including those submitted through io_uring
+    atomic_ulong stat_calls;
+    atomic_ulong mkdir_calls;
+    // Directories opened to run system calls relative to them
+    atomic_ulong open_calls;
+    atomic_ulong directories_created;
+    atomic_ulong already_exists;
+    atomic_ulong failed_makes;
+    atomic_ulong failed_gos;
+    // Statements answered from the previous run's journal instead of the filesystem
+    atomic_ulong journal_replayed;
+    // Nanoseconds spent in each phase, summed over scripts
+    atomic_ulong lex_ns;
+    atomic_ulong compile_ns;
+    atomic_ulong execute_ns;
+} Stats;
+
+
+// Directory names and resolved paths, shared by everything in the process
+Interner interner;
+PathTrie trie;
+// Set while scripts run in parallel ('-j'): the tables above are then only changed
+// under names_mutex. Atoms and path nodes never move, and a node's name and parent
+// never change, so they can be read without the lock.
+bool names_shared;
+pthread_mutex_t names_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Where this thread reports script errors; NULL is stdout
+_Thread_local FILE* diagnostics;
+// Instrumentation for '--stats'
+Stats stats;
+// Byte classifier used by the lexer: the widest one the processor supports, chosen once
+ByteClasses (*classify_bytes)(const char* text, size_t n);
+pthread_once_t classify_once = PTHREAD_ONCE_INIT;
+// Directories the batch engines may keep open at once, for the bases of a round and again
+// for those the ring opens: a quarter of the soft limit on open files each, chosen once
+size_t open_budget;
+pthread_once_t budget_once = PTHREAD_ONCE_INIT;
+
+
+// Function prototypes
+bool add_script(ScriptList* list, const char* name);
+bool add_scripts(ScriptList* list, const char* arg);
+bool add_script_list(ScriptList* list, const char* filename);
+bool run_script(const char* filename, Executor* ex, PathNode* start, bool dump_lex);
+bool compile_source(const char* text, size_t size, Program* program, bool dump_lex);
+void execute_program(const Program* program, Executor* ex, PathNode* start);
+void report_error(const char* format, ...);
+uint64_t clock_ns(void);
+void write_stats(FILE* fptr, uint64_t wall_ns);
+bool serve(const char* socket_path, PathNode* start);
+void* serve_client(void* arg);
+bool serve_request(Server* server, FILE* in, Executor* ex, PathNode** start, char* line);
+CachedScript* cache_acquire(Server* server, const char* key, size_t key_len, bool is_file,
+                            const struct stat* sb, const char* text, size_t size);
+void cache_release(Server* server, CachedScript* script);
+void cache_forget_paths(void);
+int connect_server(const char* socket_path, ScriptList* scripts);
+void* script_worker(void* arg);
+int compare_names(const void* a, const void* b);
+bool load_script(const char* filename, Program* program, bool dump_lex);
+bool has_extension(const char* filename, const char* extension);
+bool write_compiled(const Program* program, const char* filename);
+bool load_compiled(const char* filename, Program* program);
+bool compile_script(const char* filename);
+bool journal_open(Journal* journal, const char* directory);
+bool journal_save(Journal* journal);
+void journal_free(Journal* journal);
+char journal_find(const JournalTable* table, uint64_t key);
+bool journal_insert(JournalTable* table, uint64_t key, char result);
+uint64_t hash_mix(uint64_t hash, uint64_t value);
+uint64_t journal_key(Executor* ex, const char* folder);
+bool journal_replay(Executor* ex, PathNode* target, uint64_t key);
+void journal_record(Executor* ex, uint64_t key, bool exists);
+void journal_enter(Executor* ex, const Instruction* ins);
+bool statement_exists(Executor* ex, PathNode* target, const char* folder);
+TokenType checkIfKeyWord(const char *str, size_t len);
+TokenType isbracket(char c);
+bool checkIfAlphaString(const char *str, size_t len);
+bool checkIfNumber(const char *str, size_t len);
+TokenType findTokenType(const char *str, size_t len);
+bool source_open(const char* filename, Source* source);
+void source_close(Source* source);
+bool lex(const char* text, size_t size, TokenStream* ts);
+bool lex_span(const char* text, size_t begin, size_t end, TokenStream* ts, LexChunk* chunk);
+void choose_classifier(void);
+ByteClasses classify_scalar(const char* text, size_t n);
+#if defined(__x86_64__) && defined(__GNUC__)
+ByteClasses classify_sse2(const char* text, size_t n);
+ByteClasses classify_avx2(const char* text, size_t n);
+#endif
+bool lex_parallel(const char* text, size_t size, TokenStream* ts, int threads);
+void* lex_worker(void* arg);
+void* lex_finish(void* arg);
+uint32_t chunk_name(LexChunk* chunk, const char* name, size_t len);
+bool lex_word(const char* text, size_t offset, size_t len, bool plain, TokenStream* ts, LexChunk* chunk);
+bool push_token(TokenStream* ts, TokenType type, uint32_t atom, size_t offset, size_t length);
+const char* next_token(TokenStream* ts);
+bool dump_tokens(TokenStream* ts, const char* filename);
+void free_tokens(TokenStream* ts);
+bool parse_program(TokenStream* ts, Program* program);
+bool parse_statement(TokenStream* ts, Program* program);
+bool parse_command(TokenStream* ts, Program* program);
+bool parse_repeat(TokenStream* ts, Program* program);
+bool parse_define(TokenStream* ts, Program* program);
+size_t template_hash(uint32_t parent, uint32_t atom);
+bool template_child(TokenStream* ts, Program* program, Template* template, uint32_t parent,
+                    uint32_t name, uint32_t* node);
+bool parse_use(TokenStream* ts, Program* program);
+bool find_template(const Program* program, uint32_t atom, uint32_t* index);
+bool path_expands(const Program* program, const PathExpr* path);
+bool parse_path(TokenStream* ts, Program* program, PathExpr* path);
+bool parse_name(TokenStream* ts, Program* program, PathExpr* path);
+bool parse_index(TokenStream* ts, PathPart* part);
+bool name_continues(const TokenStream* ts);
+bool parse_number(TokenStream* ts, uint32_t* value);
+bool push_name(Program* program, uint32_t atom);
+bool push_part(Program* program, PathPart part);
+bool push_template(Program* program, Template template);
+bool push_template_node(Program* program, TemplateNode node);
+Instruction* emit(Program* program, OpCode op);
+void free_program(Program* program);
+size_t name_hash(const char* name, size_t len);
+size_t fold_hash(const char* name, size_t len);
+uint32_t intern(const char* name, size_t len);
+uint32_t intern_name(const char* name, size_t len, bool fold);
+uint32_t intern_locked(const char* name, size_t len, bool fold);
+Atom* atom_at(uint32_t atom);
+const char* atom_name(uint32_t atom);
+size_t child_hash(const PathNode* parent, uint32_t atom);
+PathNode* path_root(void);
+PathNode* path_child(PathNode* parent, uint32_t atom);
+PathNode* path_child_locked(PathNode* parent, uint32_t atom);
+void names_lock(void);
+void names_unlock(void);
+void* arena_alloc(Arena* arena, size_t size);
+void arena_reset(Arena* arena);
+void arena_free(Arena* arena);
+PathNode* path_from_string(const char* folder);
+char* path_string(const PathNode* node, char* folder);
+void cache_mark_exists(PathNode* node);
+void cache_mark_created(PathNode* node);
+bool path_exists(Executor* ex, PathNode* node);
+const char* path_text(Executor* ex, const PathNode* node);
+int dir_open(Executor* ex, PathNode* node);
+void dir_cache_clear(Executor* ex);
+int path_stat(Executor* ex, PathNode* node, struct stat* sb);
+PathNode* resolve_path(Executor* ex, const PathExpr* path);
+uint32_t build_name(Executor* ex, const PathPart* parts, uint32_t count, const uint64_t* at, uint32_t start, char* name, size_t* len);
+void go(const Instruction* ins, Executor* ex);
+void make(const Instruction* ins, Executor* ex);
+void make_target(Executor* ex, PathNode* target, bool queue);
+void expand(const Instruction* ins, Executor* ex);
+void use(const Instruction* ins, Executor* ex);
+uint64_t part_size(const PathPart* part);
+size_t part_value(Executor* ex, const PathPart* part, uint64_t at, char* name, size_t size);
+void say(Executor* ex, const char* format, ...);
+void report_make(Executor* ex, const char* folder, int created, size_t first_created);
+int make_path(Executor* ex, PathNode* node, size_t* first_created);
+bool ifPath_maker(const Instruction* ins, Executor* ex);
+bool ifnot(const Instruction* ins, Executor* ex);
+void translate(const Program* program, Executor* ex);
+void batch_add(MakeBatch* batch, PathNode* target, uint64_t key);
+void deque_push(WorkDeque* deque, BatchNode* node);
+BatchNode* deque_take(WorkDeque* deque, bool steal);
+void batch_fail(BatchNode* node, int error);
+BatchNode* batch_open_bases(Executor* ex, BatchNode* first);
+void batch_create(WorkPool* pool, int worker, BatchNode* node);
+void* batch_worker(void* arg);
+void pool_wake(WorkPool* pool);
+int flush_makes(Executor* ex);
+void create_batch_threads(MakeBatch* batch, BatchNode* first, BatchNode* last, int threads);
+void batch_reset(BatchNode* node);
+void choose_open_budget(void);
+void clear_batch(MakeBatch* batch);
+void free_batch(MakeBatch* batch);
+void scan_directory(Executor* ex, PathNode* node);
+void scan_entry(Executor* ex, PathNode* node, int fd, const char* name, unsigned char type);
+bool plan_exists(Executor* ex, PathNode* node);
+void plan_make(Executor* ex, PathNode* target, const char* folder);
+void push_node(NodeList* list, PathNode* node);
+bool path_under(const PathNode* node, const PathNode* root);
+void reconcile_mark(NodeList* wanted, PathNode* root, PathNode* node, bool under, uint8_t mark);
+bool reconcile(Executor* ex, PathNode* root, bool apply);
+void write_relative_path(FILE* fptr, PathNode* from, PathNode* to);
+bool write_plan(Executor* ex, PathNode* start, const char* filename);
+bool uring_open(Uring* ring);
+void uring_close(Uring* ring);
+bool uring_create_batch(Uring* ring, MakeBatch* batch, BatchNode* first, BatchNode* last);
+#ifdef __linux__
+bool uring_run(Uring* ring, UringOp* ops, size_t count);
+#endif
+
+
+// Initial number of token slots; the array doubles when full
+#define TOKENS_INITIAL 1024
+
+// Sources of at least two parts of this many bytes are lexed on several threads, one part each
+#define LEX_CHUNK_MIN (1024 * 1024)
+
+// Initial number of slots of the name and path hash tables; they double when three quarters full
+#define TABLE_INITIAL 1024
+
+// Bytes of each block of an arena, unless a larger allocation needs a larger one
+#define ARENA_BLOCK (256 * 1024)
+
+// Alignment of every arena allocation, and the size of a block's header rounded up to it
+#define ARENA_ALIGN _Alignof(max_align_t)
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+// Batches with fewer directories than this are created on the calling thread only
+#define PARALLEL_MIN_DIRECTORIES 64
+
+// Submission queue size of the io_uring backend
+#define URING_ENTRIES 256
+
+// Most directories the batch engines keep open for a round, whatever the limit on open files
+#define OPEN_BUDGET_MAX 4096
+
+// Compiled scripts kept by '--serve'; the least recently used unused one is dropped beyond this
+#define SCRIPT_CACHE_MAX 1024
+
+// File kept in the starting directory by '--journal'
+#define JOURNAL_NAME ".path_maker.journal"
+
+// '--reconcile' marks of a directory: a make target, and an ancestor of one
+#define WANTED_TARGET 1
+#define WANTED_ABOVE 2
+
+// Bytes of directory entries read per getdents64 call
+#define DIRENT_BUFFER 32768
+
+// Format version of compiled (.pmc) files; files of another version must be compiled again
+#define PMC_VERSION 4
+
+// Expanded make targets queued for '--threads'/'--io-uring' before they are created
+#define EXPAND_BATCH 4096
+
+// Lowercase an ASCII letter
+#define FOLD(c) ((c) >= 'A' && (c) <= 'Z' ? (c) + ('a' - 'A') : (c))
+
+// Add to a '--stats' counter
+#define COUNT(counter, n) atomic_fetch_add_explicit(&stats.counter, (n), memory_order_relaxed)
+
+
+// Main program logic
+// (left out when main.c is built into another program, such as bench/bench.c)
+#ifndef PATH_MAKER_NO_MAIN
+int main(int argc, char* argv[])
+{
+
+    // '--dump-lex' writes the generated tokens to 'code.lex' for debugging
+    // '--threads N' creates the directories of consecutive make statements on N threads
+    // '--io-uring' creates them with batched io_uring submissions where the kernel supports it
+    // '--cache trust|verify' answers from memory for the paths it has made or looked at, or
+    // re-checks every path every time (the default)
+    // '--plan FILE' simulates the script and writes the directories it would create to FILE
+    // '-j N' runs N of the scripts named on the command line at a time
+    // '--list FILE' runs the scripts listed in FILE, one per line; other arguments name
+    // scripts or directories of scripts, and without any the script name is prompted for
+    // '--serve SOCKET' runs scripts submitted over a Unix socket; '--connect SOCKET' submits them
+    // '--reconcile report|apply' compares the directories the script wants with those on disk,
+    // and with 'apply' creates the missing ones
+    // '--journal' keeps what each statement found in the starting directory; an unchanged
+    // statement that found a directory last time only checks that it is still there. That
+    // saves the mkdirat of each such make and nothing else: it costs one fstatat instead,
+    // and conditions and opens cost what they cost without the journal
+    ScriptList scripts = {NULL, 0, 0};
+    const char* serve_socket = NULL;
+    const char* connect_socket = NULL;
+    const char* plan_file = NULL;
+    const char* reconcile_mode = NULL;
+    int jobs = 1;
+    // '--stats' writes counters and phase times as JSON to standard error at exit
+    bool show_stats = false;
+    bool keep_journal = false;
+    // '--compile' writes each .pmk script as a compiled .pmc file instead of running it;
+    // .pmc files named as scripts run without being lexed or parsed
+    bool compile_only = false;
+    uint64_t started_ns = clock_ns();
+    bool dump_lex = false;
+    bool trust_cache = false;
+    bool io_uring = false;
+    int threads = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--dump-lex"))
+        {
+            dump_lex = true;
+        }
+        else if (!strcmp(argv[i], "--stats"))
+        {
+            show_stats = true;
+        }
+        else if (!strcmp(argv[i], "--compile"))
+        {
+            compile_only = true;
+        }
+        else if (!strcmp(argv[i], "--journal"))
+        {
+            keep_journal = true;
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--io-uring"))
+        {
+            io_uring = true;
+        }
+        else if (!strcmp(argv[i], "--cache") && i + 1 < argc
+                 && (!strcmp(argv[i + 1], "trust") || !strcmp(argv[i + 1], "verify")))
+        {
+            trust_cache = !strcmp(argv[++i], "trust");
+        }
+        else if (!strcmp(argv[i], "--plan") && i + 1 < argc)
+        {
+            plan_file = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--reconcile") && i + 1 < argc
+                 && (!strcmp(argv[i + 1], "report") || !strcmp(argv[i + 1], "apply")))
+        {
+            reconcile_mode = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--serve") && i + 1 < argc)
+        {
+            serve_socket = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--connect") && i + 1 < argc)
+        {
+            connect_socket = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            jobs = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--list") && i + 1 < argc)
+        {
+            if (!add_script_list(&scripts, argv[++i]))
+            {
+                return 1;
+            }
+        }
+        else if (argv[i][0] != '-')
+        {
+            if (!add_scripts(&scripts, argv[i]))
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error. Unknown option: %s\nUsage: %s [--dump-lex] [--stats] [--compile] [--journal] [--threads N] [--io-uring] [--cache trust|verify] [--plan FILE] [--reconcile report|apply] [-j N] [--list FILE] [--serve SOCKET | --connect SOCKET] [SCRIPT|DIRECTORY]...\n", argv[i], argv[0]);
+            return 1;
+        }
+    }
+    // Scripts run with '-j' each have their own executor, so there is no single plan,
+    // reconciliation or journal for them to share
+    if (jobs > 1 && (plan_file != NULL || reconcile_mode != NULL || keep_journal))
+    {
+        printf("Error. -j cannot be combined with --plan, --reconcile or --journal.\n");
+        return 1;
+    }
+
+    /*
+        Take in file name for the source code file and open
+        it if it exists.
+    */
+
+    // The server reads its scripts from clients
+    if (serve_socket != NULL)
+    {
+        char cwd[PATH_MAX];
+        if (getcwd(cwd, sizeof(cwd)) == NULL)
+        {
+            printf("Error getting current directory.\nExiting...\n");
+            return 1;
+        }
+        if (trust_cache)
+        {
+            printf("Warning. --cache trust is ignored by --serve: every request checks the disk.\n");
+        }
+        return serve(serve_socket, path_from_string(cwd)) ? 0 : 1;
+    }
+
+    // Scripts given on the command line run without prompting
+    if (scripts.count == 0)
+    {
+        // Create character string to hold input
+        // PATH_MAX is OS specific max path length
+        char input[PATH_MAX + 1];
+        printf("Enter file name (without the .pmk extension): ");
+        // Take in input
+        scanf("%s", input);
+        // Concatenate file name with the .pmk extension
+        strcat(input, ".pmk");
+        add_script(&scripts, input);
+    }
+    if (connect_socket != NULL)
+    {
+        return connect_server(connect_socket, &scripts);
+    }
+    if (compile_only)
+    {
+        int failed = 0;
+        for (size_t i = 0; i < scripts.count; i++)
+        {
+            failed += !compile_script(scripts.names[i]);
+        }
+        return failed ? 1 : 0;
+    }
+
+    // Every script starts in the current
+    // (location of this program at execution) directory
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == NULL)
+    {
+        printf("Error getting current directory.\nExiting...\n");
+        return 1;
+    }
+    PathNode* start = path_from_string(cwd);
+
+    // Independent scripts in parallel: one executor per thread, each creating its
+    // directories itself, sharing the names, the trie and the existence cache
+    if (jobs > 1 && scripts.count > 1)
+    {
+        if (jobs > (int)scripts.count)
+        {
+            jobs = scripts.count;
+        }
+        ScriptQueue queue = {&scripts, 0, 0, start, trust_cache, dump_lex};
+        pthread_t* workers = malloc(jobs * sizeof(pthread_t));
+        if (workers == NULL)
+        {
+            printf("Error. Out of memory while starting jobs.\nExiting...\n");
+            return 1;
+        }
+        names_shared = true;
+        int started = 0;
+        while (started < jobs && pthread_create(&workers[started], NULL, script_worker, &queue) == 0)
+        {
+            started++;
+        }
+        if (started == 0)
+        {
+            script_worker(&queue);
+        }
+        for (int i = 0; i < started; i++)
+        {
+            pthread_join(workers[i], NULL);
+        }
+        names_shared = false;
+        free(workers);
+        printf("Ran %zu scripts, %d failed.\n", scripts.count, (int)queue.failed);
+        if (show_stats)
+        {
+            write_stats(stderr, clock_ns() - started_ns);
+        }
+        return queue.failed ? 1 : 0;
+    }
+
+    // Execution state shared by the scripts, run one after the other
+    static Executor ex;
+    ex.threads = threads;
+    ex.trust_cache = trust_cache;
+    ex.batch.root.fd = -1;
+    ex.ring.fd = -1;
+    ex.out = stdout;
+    bool apply = reconcile_mode != NULL && !strcmp(reconcile_mode, "apply");
+    if (plan_file != NULL || reconcile_mode != NULL)
+    {
+        // The starting directory exists; everything else is read from disk when first needed
+        ex.planning = true;
+        ex.reconciling = reconcile_mode != NULL;
+        ex.out = NULL;
+        cache_mark_exists(start);
+    }
+    if (io_uring && (!ex.planning || apply) && !uring_open(&ex.ring))
+    {
+        printf("io_uring is not available. Directories will be created synchronously.\n");
+    }
+    static Journal journal;
+    if (keep_journal && !ex.planning)
+    {
+        if (!journal_open(&journal, cwd))
+        {
+            printf("Error. Out of memory while reading the journal.\nExiting...\n");
+            return 1;
+        }
+        ex.journal = &journal;
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < scripts.count; i++)
+    {
+        if (scripts.count > 1)
+        {
+            printf("Script: %s\n", scripts.names[i]);
+        }
+        if (!run_script(scripts.names[i], &ex, start, dump_lex))
+        {
+            failed++;
+        }
+    }
+    if (reconcile_mode != NULL && !reconcile(&ex, start, apply))
+    {
+        failed++;
+    }
+    uring_close(&ex.ring);
+    if (ex.journal != NULL && !journal_save(&journal))
+    {
+        printf("Error writing the journal to %s.\n", journal.filename);
+        failed++;
+    }
+    if (plan_file != NULL && !write_plan(&ex, start, plan_file))
+    {
+        printf("Error writing the plan to %s.\nExiting...\n", plan_file);
+        return 1;
+    }
+    if (scripts.count > 1)
+    {
+        printf("Ran %zu scripts, %d failed.\n", scripts.count, failed);
+    }
+    if (show_stats)
+    {
+        write_stats(stderr, clock_ns() - started_ns);
+    }
+    return failed ? 1 : 0;
+}
+#endif
+
+
+/*********************************************************************
+ * Scripts: each one is lexed, compiled and executed in turn from    *
+ * the starting directory. With '-j N' that many threads take the    *
+ * scripts in order, each with an executor of its own; a script's    *
+ * messages are collected and printed together once it has finished. *
+ *********************************************************************/
+
+
+// Add a script file to the list
+bool add_script(ScriptList* list, const char* name)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        char** names = realloc(list->names, list->capacity * sizeof(char*));
+        if (names == NULL)
+        {
+            return false;
+        }
+        list->names = names;
+    }
+    list->names[list->count] = strdup(name);
+    return list->names[list->count++] != NULL;
+}
+
+
+// Compare two script names, for sorting the scripts of a directory
+int compare_names(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+
+// Add a script named on the command line: a .pmk file (the extension may be left
+// out, as at the prompt) or a directory, whose .pmk files are added in name order
+bool add_scripts(ScriptList* list, const char* arg)
+{
+    struct stat sb;
+    if (stat(arg, &sb) != 0)
+    {
+        char name[PATH_MAX];
+        if (snprintf(name, sizeof(name), "%s.pmk", arg) < (int)sizeof(name) && stat(name, &sb) == 0)
+        {
+            return add_script(list, name);
+        }
+        printf("Error. Script %s could not be found.\n", arg);
+        return false;
+    }
+    if (!S_ISDIR(sb.st_mode))
+    {
+        return add_script(list, arg);
+    }
+
+    DIR* dir = opendir(arg);
+    if (dir == NULL)
+    {
+        printf("Error. Directory %s could not be read.\n", arg);
+        return false;
+    }
+    size_t first = list->count;
+    for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir))
+    {
+        size_t len = strlen(entry->d_name);
+        if (len > 4 && !strcmp(entry->d_name + len - 4, ".pmk"))
+        {
+            char name[PATH_MAX];
+            snprintf(name, sizeof(name), "%s/%s", arg, entry->d_name);
+            if (!add_script(list, name))
+            {
+                closedir(dir);
+                return false;
+            }
+        }
+    }
+    closedir(dir);
+    qsort(list->names + first, list->count - first, sizeof(char*), compare_names);
+    return true;
+}
+
+
+// Add the scripts of a list file: one script or directory per line, blank lines ignored
+bool add_script_list(ScriptList* list, const char* filename)
+{
+    FILE* fptr = fopen(filename, "r");
+    if (fptr == NULL)
+    {
+        printf("Error. Script list %s could not be read.\n", filename);
+        return false;
+    }
+    char line[PATH_MAX + 2];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fptr) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (*line != '\0')
+        {
+            ok = add_scripts(list, line);
+        }
+    }
+    fclose(fptr);
+    return ok;
+}
+
+
+// Lex, compile and execute one script from the starting directory, then create
+// whatever makes are still queued; false if it could not be read or compiled
+bool run_script(const char* filename, Executor* ex, PathNode* start, bool dump_lex)
+{
+    Program program = {0};
+    if (!load_script(filename, &program, dump_lex))
+    {
+        return false;
+    }
+    execute_program(&program, ex, start);
+    free_program(&program);
+    return true;
+}
+
+
+// Compile a .pmk script, or load a compiled .pmc one; false (with the error reported) on failure
+bool load_script(const char* filename, Program* program, bool dump_lex)
+{
+    if (has_extension(filename, ".pmc"))
+    {
+        return load_compiled(filename, program);
+    }
+
+    // Map the file into memory
+    Source source;
+    // Check for errors in opening file
+    if (!source_open(filename, &source))
+    {
+        report_error("The source code file could not be found/read.\nExiting...\n");
+        return false;
+    }
+    bool compiled = compile_source(source.data, source.size, program, dump_lex);
+    source_close(&source);
+    return compiled;
+}
+
+
+// Lex and compile source text into a program; false (with the error reported) if it is invalid
+bool compile_source(const char* text, size_t size, Program* program, bool dump_lex)
+{
+    /*********************************************************************
+     * This subprogram reads in source code for the path_maker language *
+     * and generates tokens to be used by the parser.                   *
+     ********************************************************************/
+    // Token array filled by the lexer and read by the parser
+    uint64_t began = clock_ns();
+    TokenStream tokens = {.type = t_None, .source = text};
+    if (!lex(text, size, &tokens))
+    {
+        free_tokens(&tokens);
+        return false;
+    }
+    uint64_t lexed = clock_ns();
+    COUNT(lex_ns, lexed - began);
+    COUNT(tokens, tokens.count);
+
+    if (dump_lex && !dump_tokens(&tokens, "code.lex"))
+    {
+        report_error("Error writing code.lex.\nExiting...\n");
+        free_tokens(&tokens);
+        return false;
+    }
+
+
+    /************************************************
+     * This subprogram is the parser for path_maker *
+     ************************************************/
+
+    // Compile the tokens into a flat program in a single pass; every syntax
+    // error is reported here, before any command is executed
+    bool compiled = parse_program(&tokens, program);
+    free_tokens(&tokens);
+    COUNT(compile_ns, clock_ns() - lexed);
+    if (!compiled)
+    {
+        report_error("Exiting...\n");
+        return false;
+    }
+    COUNT(statements, program->count);
+    return true;
+}
+
+
+// Execute a compiled program from the starting directory, then create whatever makes are still queued
+void execute_program(const Program* program, Executor* ex, PathNode* start)
+{
+    // The planner discards statement messages but still shows where it starts
+    fprintf(ex->out ? ex->out : stdout, "Current directory: %s\n", path_text(ex, start));
+
+    // The starting directory exists, so that queued makes below it are rooted there
+    uint64_t began = clock_ns();
+    cache_mark_exists(start);
+    ex->cwd = start;
+    translate(program, ex);
+    flush_makes(ex);
+    dir_cache_clear(ex);
+    COUNT(execute_ns, clock_ns() - began);
+}
+
+
+// Run scripts from the shared queue until none are left
+void* script_worker(void* arg)
+{
+    ScriptQueue* queue = arg;
+    Executor* ex = calloc(1, sizeof(Executor));
+    if (ex == NULL)
+    {
+        printf("Error. Out of memory while starting a job.\n");
+        atomic_fetch_add(&queue->failed, 1);
+        return NULL;
+    }
+    ex->threads = 1;
+    ex->trust_cache = queue->trust_cache;
+    ex->batch.root.fd = -1;
+    ex->ring.fd = -1;
+
+    for (size_t i = atomic_fetch_add(&queue->next, 1); i < queue->scripts->count;
+         i = atomic_fetch_add(&queue->next, 1))
+    {
+        const char* name = queue->scripts->names[i];
+        char* text = NULL;
+        size_t size = 0;
+        ex->out = open_memstream(&text, &size);
+        if (ex->out == NULL)
+        {
+            ex->out = stdout;
+        }
+        diagnostics = ex->out;
+        bool ok = run_script(name, ex, queue->start, queue->dump_lex);
+        diagnostics = NULL;
+        if (ex->out != stdout)
+        {
+            fclose(ex->out);
+        }
+
+        flockfile(stdout);
+        printf("Script: %s\n", name);
+        if (text != NULL)
+        {
+            fwrite(text, 1, size, stdout);
+        }
+        funlockfile(stdout);
+        free(text);
+        if (!ok)
+        {
+            atomic_fetch_add(&queue->failed, 1);
+        }
+    }
+    free_batch(&ex->batch);
+    free(ex->instance.nodes);
+    free(ex->text);
+    free(ex);
+    return NULL;
+}
+
+
+/*********************************************************************
+ * Server: '--serve SOCKET' listens on a Unix domain socket and runs *
+ * scripts for its clients, one thread per connection, keeping the   *
+ * interned names, the path trie and the compiled scripts between    *
+ * requests. Directories change on disk between requests, so the     *
+ * server always runs with '--cache verify'. It runs scripts with    *
+ * its own permissions: the socket is made with mode 0600 and only   *
+ * the server's user (or root) is served. A connection carries       *
+ * requests one after the other:                                     *
+ *                                                                   *
+ *   cwd DIRECTORY       run the following requests from DIRECTORY   *
+ *   file PATH           run a script file (recompiled if changed)   *
+ *   source LENGTH       run the LENGTH bytes of source that follow  *
+ *   forget              drop what is known about existing paths     *
+ *                                                                   *
+ * The messages of each statement are sent as they happen, and every *
+ * request ends with the line 'done 0' (ran) or 'done 1' (failed).   *
+ * '--connect SOCKET' is the matching client.                        *
+ *********************************************************************/
+
+
+// Report a script error to this thread's diagnostics stream
+void report_error(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(diagnostics ? diagnostics : stdout, format, args);
+    va_end(args);
+}
+
+
+// Monotonic time in nanoseconds
+uint64_t clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+
+// Write the '--stats' report as one JSON object
+void write_stats(FILE* fptr, uint64_t wall_ns)
+{
+    fprintf(fptr, "{\n");
+    fprintf(fptr, "  \"seconds\": {\"lex\": %.6f, \"compile\": %.6f, \"execute\": %.6f, \"total\": %.6f},\n",
+            stats.lex_ns / 1e9, stats.compile_ns / 1e9, stats.execute_ns / 1e9, wall_ns / 1e9);
+    fprintf(fptr, "  \"tokens\": %lu,\n", (unsigned long)stats.tokens);
+    fprintf(fptr, "  \"statements\": %lu,\n", (unsigned long)stats.statements);
+    fprintf(fptr, "  \"executed\": %lu,\n", (unsigned long)stats.executed);
+    fprintf(fptr, "  \"stat_calls\": %lu,\n", (unsigned long)stats.stat_calls);
+    fprintf(fptr, "  \"mkdir_calls\": %lu,\n", (unsigned long)stats.mkdir_calls);
+    fprintf(fptr, "  \"open_calls\": %lu,\n", (unsigned long)stats.open_calls);
+    fprintf(fptr, "  \"directories_created\": %lu,\n", (unsigned long)stats.directories_created);
+    fprintf(fptr, "  \"already_exists\": %lu,\n", (unsigned long)stats.already_exists);
+    fprintf(fptr, "  \"failed_makes\": %lu,\n", (unsigned long)stats.failed_makes);
+    fprintf(fptr, "  \"failed_gos\": %lu,\n", (unsigned long)stats.failed_gos);
+    fprintf(fptr, "  \"journal_replayed\": %lu\n", (unsigned long)stats.journal_replayed);
+    fprintf(fptr, "}\n");
+}
+
+
+// Listen on a Unix socket and serve each connection on its own thread; returns only on error
+bool serve(const char* socket_path, PathNode* start)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        printf("Error. Socket path %s is too long.\n", socket_path);
+        return false;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    // A socket left behind by an earlier server is replaced
+    struct stat sb;
+    if (lstat(socket_path, &sb) == 0 && S_ISSOCK(sb.st_mode))
+    {
+        unlink(socket_path);
+    }
+    // The socket is made for the server's user only: a client can create directories
+    // anywhere the server can
+    static Server server;
+    server.fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    mode_t mask = umask(0177);
+    bool bound = server.fd >= 0 && bind(server.fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    umask(mask);
+    if (!bound || listen(server.fd, SOMAXCONN) != 0)
+    {
+        printf("Error. Could not listen on %s: %s\n", socket_path, strerror(errno));
+        return false;
+    }
+    server.start = start;
+    pthread_mutex_init(&server.lock, NULL);
+    names_shared = true;
+
+    // A client that goes away mid-request must not end the server
+    signal(SIGPIPE, SIG_IGN);
+    printf("Serving on %s\n", socket_path);
+    fflush(stdout);
+
+    for (;;)
+    {
+        int fd = accept4(server.fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            printf("Error. Could not accept a connection: %s\n", strerror(errno));
+            return false;
+        }
+#ifdef SO_PEERCRED
+        // Whatever the socket's mode, other users are not served
+        struct ucred peer;
+        socklen_t peer_len = sizeof(peer);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peer_len) != 0
+            || (peer.uid != geteuid() && peer.uid != 0))
+        {
+            close(fd);
+            continue;
+        }
+#endif
+        ServerClient* client = malloc(sizeof(ServerClient));
+        pthread_t thread;
+        if (client == NULL)
+        {
+            close(fd);
+            continue;
+        }
+        client->server = &server;
+        client->fd = fd;
+        if (pthread_create(&thread, NULL, serve_client, client) != 0)
+        {
+            close(fd);
+            free(client);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+}
+
+
+// Serve the requests of one connection until the client closes it
+void* serve_client(void* arg)
+{
+    ServerClient* client = arg;
+    Server* server = client->server;
+    int fd = client->fd;
+    FILE* in = fdopen(fd, "r");
+    int out_fd = dup(fd);
+    FILE* out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    Executor* ex = calloc(1, sizeof(Executor));
+    free(client);
+    if (in == NULL || out == NULL || ex == NULL)
+    {
+        if (in != NULL) fclose(in);
+        else close(fd);
+        if (out != NULL) fclose(out);
+        else if (out_fd >= 0) close(out_fd);
+        free(ex);
+        return NULL;
+    }
+
+    // Each statement's messages reach the client as soon as they are printed
+    setvbuf(out, NULL, _IOLBF, 0);
+    ex->threads = 1;
+    // Directories are created and removed behind the server's back between requests
+    ex->trust_cache = false;
+    ex->batch.root.fd = -1;
+    ex->ring.fd = -1;
+    ex->out = out;
+    diagnostics = out;
+
+    PathNode* start = server->start;
+    char line[PATH_MAX + 16];
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        // A request that does not fit is refused whole, not read as several
+        if (strchr(line, '\n') == NULL && !feof(in))
+        {
+            int c;
+            do
+            {
+                c = getc(in);
+            }
+            while (c != EOF && c != '\n');
+            fprintf(out, "Error. Request is longer than %d characters.\ndone 1\n", (int)sizeof(line) - 2);
+            if (c == EOF || fflush(out) != 0)
+            {
+                break;
+            }
+            continue;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        if (*line == '\0')
+        {
+            continue;
+        }
+        if (!serve_request(server, in, ex, &start, line))
+        {
+            break;
+        }
+        if (fflush(out) != 0)
+        {
+            break;
+        }
+    }
+    fclose(in);
+    fclose(out);
+    free_batch(&ex->batch);
+    free(ex->instance.nodes);
+    free(ex->text);
+    free(ex);
+    return NULL;
+}
+
+
+// Handle one request line; false when the connection cannot continue
+bool serve_request(Server* server, FILE* in, Executor* ex, PathNode** start, char* line)
+{
+    FILE* out = ex->out;
+    if (!strncmp(line, "cwd ", 4))
+    {
+        if (line[4] != '/')
+        {
+            fprintf(out, "Error. The directory of a request must be an absolute path.\ndone 1\n");
+            return true;
+        }
+        if (strlen(line + 4) >= PATH_MAX)
+        {
+            fprintf(out, "Error. The directory of a request is longer than %d characters.\ndone 1\n", PATH_MAX - 1);
+            return true;
+        }
+        *start = path_from_string(line + 4);
+        return true;
+    }
+    if (!strcmp(line, "forget"))
+    {
+        cache_forget_paths();
+        fprintf(out, "done 0\n");
+        return true;
+    }
+
+    CachedScript* script = NULL;
+    if (!strncmp(line, "file ", 5))
+    {
+        // Relative script paths are taken from the request's directory
+        char path[PATH_MAX];
+        int len = line[5] == '/' ? snprintf(path, sizeof(path), "%s", line + 5)
+                                 : snprintf(path, sizeof(path), "%s/%s", path_text(ex, *start), line + 5);
+        if (len >= (int)sizeof(path))
+        {
+            fprintf(out, "Error. Script path is too long.\ndone 1\n");
+            return true;
+        }
+        struct stat sb;
+        if (stat(path, &sb) != 0 || !S_ISREG(sb.st_mode))
+        {
+            fprintf(out, "The source code file could not be found/read.\ndone 1\n");
+            return true;
+        }
+        script = cache_acquire(server, path, strlen(path), true, &sb, NULL, 0);
+    }
+    else if (!strncmp(line, "source ", 7))
+    {
+        char* end;
+        unsigned long long size = strtoull(line + 7, &end, 10);
+        if (*end != '\0' || end == line + 7 || size > UINT32_MAX)
+        {
+            fprintf(out, "Error. Invalid source length.\ndone 1\n");
+            return false;
+        }
+        char* text = malloc(size ? size : 1);
+        if (text == NULL || fread(text, 1, size, in) != size)
+        {
+            free(text);
+            return false;
+        }
+        script = cache_acquire(server, text, size, false, NULL, text, size);
+        free(text);
+    }
+    else
+    {
+        fprintf(out, "Error. Unknown request: %s\ndone 1\n", line);
+        return true;
+    }
+
+    if (script == NULL)
+    {
+        fprintf(out, "done 1\n");
+        return true;
+    }
+    execute_program(&script->program, ex, *start);
+    cache_release(server, script);
+    fprintf(out, "done 0\n");
+    return true;
+}
+
+
+// Find a compiled script, compiling it (outside the lock) when it is new or its
+// file has changed; NULL (with the error reported) if it does not compile
+CachedScript* cache_acquire(Server* server, const char* key, size_t key_len, bool is_file,
+                            const struct stat* sb, const char* text, size_t size)
+{
+    size_t hash = name_hash(key, key_len);
+    pthread_mutex_lock(&server->lock);
+    CachedScript** link = &server->scripts;
+    for (; *link != NULL; link = &(*link)->next)
+    {
+        CachedScript* script = *link;
+        if (script->hash != hash || script->key_len != key_len || script->is_file != is_file
+            || memcmp(script->key, key, key_len))
+        {
+            continue;
+        }
+        if (is_file && (script->dev != sb->st_dev || script->ino != sb->st_ino || script->size != sb->st_size
+                        || script->mtime.tv_sec != sb->st_mtim.tv_sec || script->mtime.tv_nsec != sb->st_mtim.tv_nsec))
+        {
+            // The file has changed: this version goes once nothing runs it
+            *link = script->next;
+            server->count--;
+            script->stale = true;
+            if (script->users == 0)
+            {
+                free_program(&script->program);
+                free(script->key);
+                free(script);
+            }
+            break;
+        }
+        // Move to the front and use it
+        *link = script->next;
+        script->next = server->scripts;
+        server->scripts = script;
+        script->users++;
+        pthread_mutex_unlock(&server->lock);
+        return script;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    CachedScript* script = calloc(1, sizeof(CachedScript));
+    if (script == NULL)
+    {
+        report_error("Error. Out of memory while compiling a script.\n");
+        return NULL;
+    }
+    bool compiled;
+    if (is_file)
+    {
+        compiled = load_script(key, &script->program, false);
+        script->dev = sb->st_dev;
+        script->ino = sb->st_ino;
+        script->size = sb->st_size;
+        script->mtime = sb->st_mtim;
+    }
+    else
+    {
+        compiled = compile_source(text, size, &script->program, false);
+    }
+    script->key = malloc(key_len ? key_len : 1);
+    if (!compiled || script->key == NULL)
+    {
+        if (compiled)
+        {
+            free_program(&script->program);
+        }
+        free(script->key);
+        free(script);
+        return NULL;
+    }
+    memcpy(script->key, key, key_len);
+    script->key_len = key_len;
+    script->hash = hash;
+    script->is_file = is_file;
+    script->users = 1;
+
+    // Two requests may have compiled the same script at once; the versions are
+    // equivalent, and the one found second will age out of the cache unused
+    pthread_mutex_lock(&server->lock);
+    script->next = server->scripts;
+    server->scripts = script;
+    server->count++;
+    if (server->count > SCRIPT_CACHE_MAX)
+    {
+        // Drop the least recently used script that is not running
+        CachedScript** last = NULL;
+        for (CachedScript** at = &server->scripts; *at != NULL; at = &(*at)->next)
+        {
+            if ((*at)->users == 0)
+            {
+                last = at;
+            }
+        }
+        if (last != NULL)
+        {
+            CachedScript* old = *last;
+            *last = old->next;
+            server->count--;
+            free_program(&old->program);
+            free(old->key);
+            free(old);
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+    return script;
+}
+
+
+// Finish running a compiled script, freeing it if it was replaced meanwhile
+void cache_release(Server* server, CachedScript* script)
+{
+    pthread_mutex_lock(&server->lock);
+    script->users--;
+    bool unused = script->stale && script->users == 0;
+    pthread_mutex_unlock(&server->lock);
+    if (unused)
+    {
+        free_program(&script->program);
+        free(script->key);
+        free(script);
+    }
+}
+
+
+// Forget whether paths exist, so the next requests check them again
+void cache_forget_paths(void)
+{
+    names_lock();
+    for (size_t i = 0; i < trie.size; i++)
+    {
+        if (trie.table[i] != NULL)
+        {
+            trie.table[i]->state = PATH_UNKNOWN;
+        }
+    }
+    names_unlock();
+}
+
+
+// Submit scripts to a server and print its replies; the exit status of the client
+int connect_server(const char* socket_path, ScriptList* scripts)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        printf("Error. Socket path %s is too long.\n", socket_path);
+        return 1;
+    }
+    strcpy(addr.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        printf("Error. Could not connect to %s: %s\n", socket_path, strerror(errno));
+        return 1;
+    }
+    FILE* in = fdopen(fd, "r");
+    FILE* out = fdopen(dup(fd), "w");
+    if (in == NULL || out == NULL)
+    {
+        printf("Error. Could not connect to %s.\n", socket_path);
+        return 1;
+    }
+
+    // Scripts run from this directory, as they would locally
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == NULL)
+    {
+        printf("Error getting current directory.\nExiting...\n");
+        return 1;
+    }
+    fprintf(out, "cwd %s\n", cwd);
+
+    int failed = 0;
+    char line[PATH_MAX + 64];
+    for (size_t i = 0; i < scripts->count; i++)
+    {
+        if (scripts->count > 1)
+        {
+            printf("Script: %s\n", scripts->names[i]);
+        }
+        fprintf(out, "file %s\n", scripts->names[i]);
+        fflush(out);
+        bool done = false;
+        while (!done && fgets(line, sizeof(line), in) != NULL)
+        {
+            if (!strncmp(line, "done ", 5))
+            {
+                done = true;
+                failed += atoi(line + 5) != 0;
+            }
+            else
+            {
+                fputs(line, stdout);
+            }
+        }
+        if (!done)
+        {
+            printf("Error. The server closed the connection.\n");
+            failed += scripts->count - i;
+            break;
+        }
+    }
+    fclose(out);
+    fclose(in);
+    if (scripts->count > 1)
+    {
+        printf("Ran %zu scripts, %d failed.\n", scripts->count, failed);
+    }
+    return failed ? 1 : 0;
+}
+
+
+/*********************************************************************
+ * Compiled scripts: '--compile' stores a script's program as a .pmc *
+ * file, which is mapped and run as it is. The instructions and the  *
+ * name array are the in-memory ones; names refer to the file's own  *
+ * string table, whose strings are interned once when it is loaded.  *
+ *********************************************************************/
+
+
+// Check whether a file name ends with an extension
+bool has_extension(const char* filename, const char* extension)
+{
+    size_t len = strlen(filename);
+    size_t ext = strlen(extension);
+    return len > ext && !strcmp(filename + len - ext, extension);
+}
+
+
+// Compile a .pmk script to a .pmc file next to it
+bool compile_script(const char* filename)
+{
+    if (has_extension(filename, ".pmc"))
+    {
+        printf("Error. %s is already compiled.\n", filename);
+        return false;
+    }
+    Program program = {0};
+    if (!load_script(filename, &program, false))
+    {
+        return false;
+    }
+    char output[PATH_MAX];
+    size_t len = strlen(filename);
+    if (has_extension(filename, ".pmk"))
+    {
+        len -= 4;
+    }
+    if (snprintf(output, sizeof(output), "%.*s.pmc", (int)len, filename) >= (int)sizeof(output))
+    {
+        printf("Error. File name %s is too long.\n", filename);
+        free_program(&program);
+        return false;
+    }
+    bool written = write_compiled(&program, output);
+    if (written)
+    {
+        printf("Compiled %s to %s (%zu instructions).\n", filename, output, program.count);
+    }
+    else
+    {
+        printf("Error writing %s.\n", output);
+    }
+    free_program(&program);
+    return written;
+}
+
+
+// Write a program as a .pmc file, giving each distinct name an index in its string table
+bool write_compiled(const Program* program, const char* filename)
+{
+    // String index + 1 of each atom the program uses
+    uint32_t* index = calloc(interner.count ? interner.count : 1, sizeof(uint32_t));
+    uint32_t* strings = malloc((program->name_count ? program->name_count : 1) * sizeof(uint32_t));
+    uint32_t* names = malloc((program->name_count ? program->name_count : 1) * sizeof(uint32_t));
+    if (index == NULL || strings == NULL || names == NULL)
+    {
+        free(index);
+        free(strings);
+        free(names);
+        return false;
+    }
+    PmcHeader header = {{'P', 'M', 'C', '\0'}, PMC_VERSION, program->count, program->name_count,
+                        program->part_count, program->template_count, program->template_node_count, 0, 0};
+    for (size_t i = 0; i < program->name_count; i++)
+    {
+        uint32_t atom = program->atoms ? program->atoms[program->names[i]] : program->names[i];
+        if (index[atom] == 0)
+        {
+            strings[header.string_count] = atom;
+            index[atom] = ++header.string_count;
+            header.string_bytes += atom_at(atom)->len;
+        }
+        names[i] = index[atom] - 1;
+    }
+
+    FILE* fptr = fopen(filename, "wb");
+    bool ok = fptr != NULL;
+    ok = ok && fwrite(&header, sizeof(header), 1, fptr) == 1;
+    ok = ok && fwrite(program->code, sizeof(Instruction), program->count, fptr) == program->count;
+    ok = ok && fwrite(names, sizeof(uint32_t), program->name_count, fptr) == program->name_count;
+    ok = ok && fwrite(program->parts, sizeof(PathPart), program->part_count, fptr) == program->part_count;
+    ok = ok && fwrite(program->templates, sizeof(Template), program->template_count, fptr) == program->template_count;
+    ok = ok && fwrite(program->template_nodes, sizeof(TemplateNode), program->template_node_count, fptr)
+               == program->template_node_count;
+    uint32_t offset = 0;
+    for (uint32_t i = 0; ok && i <= header.string_count; i++)
+    {
+        ok = fwrite(&offset, sizeof(offset), 1, fptr) == 1;
+        if (i < header.string_count)
+        {
+            offset += atom_at(strings[i])->len;
+        }
+    }
+    for (uint32_t i = 0; ok && i < header.string_count; i++)
+    {
+        const Atom* atom = atom_at(strings[i]);
+        ok = fwrite(atom->name, 1, atom->len, fptr) == atom->len;
+    }
+    if (fptr != NULL && fclose(fptr) != 0)
+    {
+        ok = false;
+    }
+    free(index);
+    free(strings);
+    free(names);
+    return ok;
+}
+
+
+// Map a .pmc file and check it before running it; false (with the error reported) if it is invalid
+bool load_compiled(const char* filename, Program* program)
+{
+    uint64_t began = clock_ns();
+    memset(program, 0, sizeof(Program));
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        report_error("The compiled file could not be found/read.\nExiting...\n");
+        return false;
+    }
+    struct stat sb;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &sb) == 0 && (size_t)sb.st_size >= sizeof(PmcHeader))
+    {
+        data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        report_error("Error. %s is not a compiled path_maker file.\nExiting...\n", filename);
+        return false;
+    }
+    program->mapping = data;
+    program->mapping_size = sb.st_size;
+
+    // Sections must fit the file exactly, with every index in range
+    const PmcHeader* header = data;
+    uint64_t size = sizeof(PmcHeader) + (uint64_t)header->instruction_count * sizeof(Instruction)
+                  + (uint64_t)header->name_count * sizeof(uint32_t)
+                  + (uint64_t)header->part_count * sizeof(PathPart)
+                  + (uint64_t)header->template_count * sizeof(Template)
+                  + (uint64_t)header->template_node_count * sizeof(TemplateNode)
+                  + ((uint64_t)header->string_count + 1) * sizeof(uint32_t) + header->string_bytes;
+    if (!memcmp(header->magic, "PMC", 4) && header->version != PMC_VERSION)
+    {
+        report_error("Error. %s was compiled by another version of path_maker. Compile it again with --compile.\nExiting...\n", filename);
+        free_program(program);
+        return false;
+    }
+    bool valid = !memcmp(header->magic, "PMC", 4) && size == (uint64_t)sb.st_size;
+    const Instruction* code = (const Instruction*)(header + 1);
+    const uint32_t* names = (const uint32_t*)(code + (valid ? header->instruction_count : 0));
+    const PathPart* parts = (const PathPart*)(names + (valid ? header->name_count : 0));
+    const Template* templates = (const Template*)(parts + (valid ? header->part_count : 0));
+    const TemplateNode* template_nodes = (const TemplateNode*)(templates + (valid ? header->template_count : 0));
+    const uint32_t* offsets = (const uint32_t*)(template_nodes + (valid ? header->template_node_count : 0));
+    const char* text = (const char*)(offsets + (valid ? header->string_count + 1 : 0));
+    // Loops must nest: each op_next closes the innermost open op_repeat, so every jump back ends
+    uint32_t loops[LOOP_DEPTH];
+    uint32_t depth = 0;
+    for (uint32_t i = 0; valid && i < header->instruction_count; i++)
+    {
+        const Instruction* ins = &code[i];
+        if (ins->op == op_repeat)
+        {
+            valid = depth < LOOP_DEPTH && ins->loop.level == depth && ins->end > i + 1
+                    && ins->end <= (depth > 0 ? code[loops[depth - 1]].end - 1 : header->instruction_count);
+            if (valid)
+            {
+                loops[depth++] = i;
+            }
+            continue;
+        }
+        if (ins->op == op_next)
+        {
+            const Instruction* repeat = depth > 0 ? &code[loops[depth - 1]] : NULL;
+            valid = repeat != NULL && repeat->end == i + 1 && ins->end == loops[depth - 1] + 1
+                    && ins->loop.level == repeat->loop.level && ins->loop.times == repeat->loop.times;
+            if (valid)
+            {
+                depth--;
+            }
+            continue;
+        }
+        uint32_t limit = ins->path.parts ? header->part_count : header->name_count;
+        valid = (ins->op <= op_expand || ins->op == op_use)
+                && ins->path.parts <= 1 && (uint64_t)ins->path.first + ins->path.count <= limit
+                && (!ins->path.parts || (ins->path.count > 0 && !parts[ins->path.first].joined))
+                && (ins->op != op_expand || ins->path.parts)
+                && ((ins->op != op_if && ins->op != op_ifnot) || (ins->end > i && ins->end <= header->instruction_count))
+                && (ins->op != op_use || ins->end < header->template_count);
+    }
+    valid = valid && depth == 0;
+    // A template's nodes come after their parents
+    for (uint32_t i = 0; valid && i < header->template_count; i++)
+    {
+        const Template* template = &templates[i];
+        valid = template->name < header->name_count
+                && (uint64_t)template->first + template->count <= header->template_node_count;
+        for (uint32_t j = 0; valid && j < template->count; j++)
+        {
+            const TemplateNode* node = &template_nodes[template->first + j];
+            valid = (node->parent == TEMPLATE_ROOT || node->parent < j)
+                    && node->name < header->name_count && node->leaf <= 1;
+        }
+    }
+    for (uint32_t i = 0; valid && i < header->name_count; i++)
+    {
+        valid = names[i] < header->string_count;
+    }
+    for (uint32_t i = 0; valid && i < header->part_count; i++)
+    {
+        const PathPart* part = &parts[i];
+        valid = part->joined <= 1 && part->width <= NAME_MAX
+                && (part->kind == part_range
+                    || (part->kind == part_index && part->first < LOOP_DEPTH)
+                    || (part->kind == part_name && part->first < header->name_count)
+                    || (part->kind == part_choice && part->first < part->last && part->last <= header->name_count));
+    }
+    for (uint32_t i = 0; valid && i < header->string_count; i++)
+    {
+        valid = offsets[i] < offsets[i + 1] && offsets[i + 1] <= header->string_bytes
+                && findTokenType(text + offsets[i], offsets[i + 1] - offsets[i]) == t_DirectoryName;
+    }
+    if (!valid)
+    {
+        report_error("Error. %s is not a compiled path_maker file.\nExiting...\n", filename);
+        free_program(program);
+        return false;
+    }
+
+    program->atoms = malloc((header->string_count ? header->string_count : 1) * sizeof(uint32_t));
+    if (program->atoms == NULL)
+    {
+        report_error("Error. Out of memory while loading %s.\n", filename);
+        free_program(program);
+        return false;
+    }
+    for (uint32_t i = 0; i < header->string_count; i++)
+    {
+        program->atoms[i] = intern_name(text + offsets[i], offsets[i + 1] - offsets[i], true);
+    }
+    program->code = (Instruction*)code;
+    program->count = header->instruction_count;
+    program->names = (uint32_t*)names;
+    program->name_count = header->name_count;
+    program->parts = (PathPart*)parts;
+    program->part_count = header->part_count;
+    program->templates = (Template*)templates;
+    program->template_count = header->template_count;
+    program->template_nodes = (TemplateNode*)template_nodes;
+    program->template_node_count = header->template_node_count;
+    COUNT(compile_ns, clock_ns() - began);
+    COUNT(statements, program->count);
+    return true;
+}
+
+
+/*********************************************************************
+ * Journal: with '--journal', the result of every go, make, if and   *
+ * ifnot is recorded in '.path_maker.journal' in the starting        *
+ * directory, under a hash of the statement as written, the absolute *
+ * path it resolved to and the if/ifnot whose command it ran in. On  *
+ * the next run the journal is only a hint, since the disk may have  *
+ * changed in between: a statement whose hash found a directory last *
+ * time checks that directory with one fstatat, and is answered from *
+ * the journal only if it is still there. A make applied last time   *
+ * then costs that fstatat instead of a mkdirat, which is the whole  *
+ * saving: a condition costs the same stat either way, and the       *
+ * directories are opened as without the journal. Anything else,     *
+ * including every condition that was false and every path that is   *
+ * gone, is evaluated again.                                         *
+ * A statement that was edited, that now resolves to another path or *
+ * that runs under another condition has a new hash.                 *
+ *                                                                   *
+ *   path_maker journal 1                                            *
+ *   HASH RESULT           one line per statement, RESULT is D or M  *
+ *********************************************************************/
+
+
+// Read the journal of a starting directory; a missing or unreadable journal is empty
+// False only when out of memory
+bool journal_open(Journal* journal, const char* directory)
+{
+    memset(journal, 0, sizeof(Journal));
+    snprintf(journal->filename, sizeof(journal->filename), "%s/%s",
+             strcmp(directory, "/") ? directory : "", JOURNAL_NAME);
+    FILE* fptr = fopen(journal->filename, "r");
+    if (fptr == NULL)
+    {
+        return true;
+    }
+    char line[64];
+    bool ok = true;
+    if (fgets(line, sizeof(line), fptr) == NULL || strcmp(line, "path_maker journal 1\n"))
+    {
+        printf("Warning. %s is not a path_maker journal. Every statement will be evaluated.\n",
+               journal->filename);
+    }
+    else
+    {
+        while (ok && fgets(line, sizeof(line), fptr) != NULL)
+        {
+            uint64_t key;
+            char result;
+            if (sscanf(line, "%16" SCNx64 " %c", &key, &result) == 2 && key != 0
+                && (result == 'D' || result == 'M'))
+            {
+                ok = journal_insert(&journal->previous, key, result);
+            }
+        }
+    }
+    fclose(fptr);
+    return ok;
+}
+
+
+// Write this run's results over the journal (through a temporary file, so a failed run
+// never leaves a partial journal behind)
+bool journal_save(Journal* journal)
+{
+    char temporary[PATH_MAX + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", journal->filename);
+    FILE* fptr = fopen(temporary, "w");
+    bool ok = fptr != NULL && fputs("path_maker journal 1\n", fptr) >= 0;
+    const JournalTable* table = &journal->current;
+    for (size_t i = 0; ok && i < table->size; i++)
+    {
+        if (table->keys[i] != 0)
+        {
+            ok = fprintf(fptr, "%016" PRIx64 " %c\n", table->keys[i], table->results[i]) > 0;
+        }
+    }
+    if (fptr != NULL && fclose(fptr) != 0)
+    {
+        ok = false;
+    }
+    ok = ok && rename(temporary, journal->filename) == 0;
+    if (!ok)
+    {
+        unlink(temporary);
+    }
+    journal_free(journal);
+    return ok;
+}
+
+
+// Release both tables of a journal
+void journal_free(Journal* journal)
+{
+    free(journal->previous.keys);
+    free(journal->previous.results);
+    free(journal->current.keys);
+    free(journal->current.results);
+    memset(&journal->previous, 0, sizeof(JournalTable));
+    memset(&journal->current, 0, sizeof(JournalTable));
+}
+
+
+// Result recorded for a statement hash, or 0 if there is none
+char journal_find(const JournalTable* table, uint64_t key)
+{
+    if (table->size == 0)
+    {
+        return 0;
+    }
+    size_t mask = table->size - 1;
+    for (size_t i = key & mask; table->keys[i] != 0; i = (i + 1) & mask)
+    {
+        if (table->keys[i] == key)
+        {
+            return table->results[i];
+        }
+    }
+    return 0;
+}
+
+
+// Record (or replace) the result of a statement hash; false when out of memory
+bool journal_insert(JournalTable* table, uint64_t key, char result)
+{
+    if ((table->count + 1) * 4 > table->size * 3)
+    {
+        size_t size = table->size ? table->size * 2 : TABLE_INITIAL;
+        uint64_t* keys = calloc(size, sizeof(uint64_t));
+        char* results = malloc(size);
+        if (keys == NULL || results == NULL)
+        {
+            free(keys);
+            free(results);
+            return false;
+        }
+        for (size_t i = 0; i < table->size; i++)
+        {
+            if (table->keys[i] != 0)
+            {
+                size_t j = table->keys[i] & (size - 1);
+                while (keys[j] != 0)
+                {
+                    j = (j + 1) & (size - 1);
+                }
+                keys[j] = table->keys[i];
+                results[j] = table->results[i];
+            }
+        }
+        free(table->keys);
+        free(table->results);
+        table->keys = keys;
+        table->results = results;
+        table->size = size;
+    }
+    size_t mask = table->size - 1;
+    size_t i = key & mask;
+    while (table->keys[i] != 0 && table->keys[i] != key)
+    {
+        i = (i + 1) & mask;
+    }
+    if (table->keys[i] == 0)
+    {
+        table->keys[i] = key;
+        table->count++;
+    }
+    table->results[i] = result;
+    return true;
+}
+
+
+// Mix a value into a journal hash
+uint64_t hash_mix(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * 1099511628211ULL;
+}
+
+
+// Hash of the running statement (never 0): its instruction, its path as written, the
+// absolute path it resolved to, and the hash of the if/ifnot whose command it is part of
+uint64_t journal_key(Executor* ex, const char* folder)
+{
+    const Program* program = ex->program;
+    const Instruction* ins = ex->statement;
+    uint64_t hash = name_hash(folder, strlen(folder));
+    hash = hash_mix(hash, (uint64_t)ins->op + 1);
+    hash = hash_mix(hash, ins->path.parents);
+    hash = hash_mix(hash, ins->path.count);
+    for (uint32_t i = 0; i < ins->path.count; i++)
+    {
+        // Names are hashed by their text, since atoms are numbered anew by each run
+        uint32_t first = ins->path.first + i;
+        uint32_t last = first + 1;
+        if (ins->path.parts)
+        {
+            const PathPart* part = &program->parts[first];
+            hash = hash_mix(hash, part->kind);
+            hash = hash_mix(hash, part->joined);
+            if (part->kind == part_name || part->kind == part_choice)
+            {
+                first = part->first;
+                last = part->kind == part_name ? first + 1 : part->last;
+            }
+            else
+            {
+                hash = hash_mix(hash, part->first);
+                hash = hash_mix(hash, part->last);
+                hash = hash_mix(hash, part->width);
+                last = first;
+            }
+        }
+        for (uint32_t n = first; n < last; n++)
+        {
+            const Atom* atom = atom_at(program->atoms ? program->atoms[program->names[n]] : program->names[n]);
+            hash = hash_mix(hash, name_hash(atom->name, atom->len));
+        }
+    }
+    if (ins->op == op_use)
+    {
+        uint32_t name = program->names[program->templates[ins->end].name];
+        const Atom* atom = atom_at(program->atoms ? program->atoms[name] : name);
+        hash = hash_mix(hash, name_hash(atom->name, atom->len));
+    }
+    if (ex->guard_count > 0)
+    {
+        hash = hash_mix(hash, ex->guards[ex->guard_count - 1].key);
+    }
+    return hash ? hash : 1;
+}
+
+
+// Answer a statement from the last run's journal: only when it found a directory, and one
+// fstatat shows that the directory is still there; true if the journal answered
+bool journal_replay(Executor* ex, PathNode* target, uint64_t key)
+{
+    if (ex->journal == NULL || journal_find(&ex->journal->previous, key) != 'D')
+    {
+        return false;
+    }
+    struct stat sb;
+    if (path_stat(ex, target, &sb) != 0 || !S_ISDIR(sb.st_mode))
+    {
+        return false;
+    }
+    cache_mark_exists(target);
+    COUNT(journal_replayed, 1);
+    return true;
+}
+
+
+// Start running the command of an if/ifnot: the statements in it are hashed with the
+// condition's hash
+void journal_enter(Executor* ex, const Instruction* ins)
+{
+    if (ex->journal == NULL)
+    {
+        return;
+    }
+    if (ex->guard_count == ex->guard_capacity)
+    {
+        ex->guard_capacity = ex->guard_capacity ? ex->guard_capacity * 2 : 16;
+        ex->guards = realloc(ex->guards, ex->guard_capacity * sizeof(JournalGuard));
+        if (ex->guards == NULL)
+        {
+            printf("Error. Out of memory while keeping the journal.\nExiting...\n");
+            exit(1);
+        }
+    }
+    uint32_t start = ins - ex->program->code;
+    ex->guards[ex->guard_count++] = (JournalGuard){start, ins->end, ex->condition};
+}
+
+
+// Record the result of a statement of this run, if a journal is kept
+void journal_record(Executor* ex, uint64_t key, bool exists)
+{
+    if (ex->journal != NULL)
+    {
+        // Out of memory only leaves the statement to be evaluated again next time
+        journal_insert(&ex->journal->current, key, exists ? 'D' : 'M');
+    }
+}
+
+
+// Check the path of a go/if/ifnot statement, answering from the journal when it can
+bool statement_exists(Executor* ex, PathNode* target, const char* folder)
+{
+    if (ex->journal == NULL)
+    {
+        return path_exists(ex, target);
+    }
+    uint64_t key = journal_key(ex, folder);
+    bool exists = journal_replay(ex, target, key) || path_exists(ex, target);
+    journal_record(ex, key, exists);
+    ex->condition = key;
+    return exists;
+}
+
+
+/*********************************************************************
+ * Lexer: the source file is mapped into memory and split into       *
+ * tokens in one pass. Tokens are slices of the mapping; directory   *
+ * names are interned straight from it, lowercased on the way, so no *
+ * identifier is ever copied into a buffer. Bytes are classified 16 *
+ * or 32 at a time, so runs of blanks and identifier characters are  *
+ * crossed in one step. Large sources are split after a ';' or '}'   *
+ * into parts lexed on one thread each.                              *
+ *********************************************************************/
+
+
+// Map a source file into memory, falling back to reading it when it cannot be mapped
+bool source_open(const char* filename, Source* source)
+{
+    source->data = "";
+    source->size = 0;
+    source->mapped = false;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode))
+    {
+        if ((uint64_t)sb.st_size > UINT32_MAX)
+        {
+            report_error("Error. Source files larger than 4 GB are not supported.\n");
+            close(fd);
+            return false;
+        }
+        if (sb.st_size == 0)
+        {
+            close(fd);
+            return true;
+        }
+        void* data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, sb.st_size, MADV_SEQUENTIAL);
+            source->data = data;
+            source->size = sb.st_size;
+            source->mapped = true;
+            close(fd);
+            return true;
+        }
+    }
+
+    // Not a regular file (or mmap failed): read it whole
+    size_t capacity = 0;
+    char* data = NULL;
+    for (;;)
+    {
+        if (source->size == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 65536;
+            char* grown = realloc(data, capacity);
+            if (grown == NULL)
+            {
+                free(data);
+                close(fd);
+                return false;
+            }
+            data = grown;
+        }
+        ssize_t n = read(fd, data + source->size, capacity - source->size);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 || source->size + n > UINT32_MAX)
+        {
+            free(data);
+            close(fd);
+            return false;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        source->size += n;
+    }
+    close(fd);
+    source->data = data ? data : "";
+    return true;
+}
+
+
+// Unmap or free a source file once nothing refers to its text any more
+void source_close(Source* source)
+{
+    if (source->mapped)
+    {
+        munmap((void*)source->data, source->size);
+    }
+    else if (source->size > 0)
+    {
+        free((void*)source->data);
+    }
+    source->data = "";
+    source->size = 0;
+    source->mapped = false;
+}
+
+
+// Split source text into tokens; prints the error and returns false on an invalid lexeme
+bool lex(const char* text, size_t size, TokenStream* ts)
+{
+    pthread_once(&classify_once, choose_classifier);
+
+    // Scripts run side by side ('-j', '--serve') already keep the cores busy
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t parts = size / LEX_CHUNK_MIN;
+    if (!names_shared && cpus > 1 && parts > 1)
+    {
+        return lex_parallel(text, size, ts, parts < (size_t)cpus ? (int)parts : (int)cpus);
+    }
+    return lex_span(text, 0, size, ts, NULL);
+}
+
+
+// Tokens of text[begin..end); a part's names are numbered by chunk_name() and its errors are left
+// for the caller to report, otherwise names are interned and an invalid lexeme is reported here
+bool lex_span(const char* text, size_t begin, size_t end, TokenStream* ts, LexChunk* chunk)
+{
+    // Start of the identifier being read, or SIZE_MAX between identifiers, and whether
+    // it is only made of letters, digits and '_' so far
+    size_t word = SIZE_MAX;
+    bool plain = true;
+    size_t i = begin;
+    while (i < end)
+    {
+        size_t n = end - i < 32 ? end - i : 32;
+        ByteClasses classes = classify_bytes(text + i, n);
+
+        // Offset in the block; a '..' at its end can take it one past
+        size_t b = 0;
+        while (b < n)
+        {
+            // Runs of identifier or blank bytes are crossed at once: the bits past the block
+            // are zero, so a run ends at the lowest set bit of the inverted mask above it
+            if (classes.word >> b & 1)
+            {
+                uint32_t rest = ~classes.word >> b;
+                size_t run = rest != 0 ? (size_t)__builtin_ctz(rest) : 32 - b;
+                uint32_t span = (run == 32 ? UINT32_MAX : (1u << run) - 1) << b;
+                if (word == SIZE_MAX)
+                {
+                    word = i + b;
+                    plain = true;
+                }
+                plain = plain && (classes.name & span) == span;
+                b += run;
+                continue;
+            }
+
+            // Anything else ends the identifier, except a lone '.' which belongs to it
+            char c = text[i + b];
+            if (c == '.' && !(i + b + 1 < end && text[i + b + 1] == '.'))
+            {
+                if (word == SIZE_MAX)
+                {
+                    word = i + b;
+                }
+                plain = false;
+                b++;
+                continue;
+            }
+            if (word != SIZE_MAX)
+            {
+                if (!lex_word(text, word, i + b - word, plain, ts, chunk))
+                {
+                    return false;
+                }
+                word = SIZE_MAX;
+            }
+            if (classes.blank >> b & 1)
+            {
+                uint32_t rest = ~classes.blank >> b;
+                b += rest != 0 ? (size_t)__builtin_ctz(rest) : 32 - b;
+                continue;
+            }
+
+            // The rest are symbols, a '.' being the first of a '..'
+            TokenType symbol = isbracket(c);
+            if (c == ';')
+            {
+                symbol = t_EndOfLine;
+            }
+            else if (c == '/')
+            {
+                symbol = t_ForwardSlash;
+            }
+            else if (c == '*')
+            {
+                symbol = t_Astrix;
+            }
+            else if (c == ',')
+            {
+                symbol = t_Comma;
+            }
+            else if (c == '.')
+            {
+                symbol = t_Range;
+            }
+            push_token(ts, symbol, 0, i + b, symbol == t_Range ? 2 : 1);
+            b += symbol == t_Range ? 2 : 1;
+        }
+        i += b;
+    }
+    return word == SIZE_MAX || lex_word(text, word, end - word, plain, ts, chunk);
+}
+
+
+// Pick the widest byte classifier the processor supports (called once, through classify_once)
+void choose_classifier(void)
+{
+    classify_bytes = classify_scalar;
+#if defined(__x86_64__) && defined(__GNUC__)
+    classify_bytes = classify_sse2;
+    if (__builtin_cpu_supports("avx2"))
+    {
+        classify_bytes = classify_avx2;
+    }
+#endif
+}
+
+
+// Classify n (at most 32) bytes one at a time; the bits past n are zero
+ByteClasses classify_scalar(const char* text, size_t n)
+{
+    ByteClasses classes = {0, 0, 0};
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned char c = text[i];
+        uint32_t bit = 1u << i;
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+        {
+            classes.blank |= bit;
+        }
+        else if (!strchr(";/*,{}<>[].", c) || c == '\0')
+        {
+            classes.word |= bit;
+        }
+        if (isalnum(c) || c == '_')
+        {
+            classes.name |= bit;
+        }
+    }
+    return classes;
+}
+
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// Classify 32 bytes, 16 at a time with SSE2 (part of every x86-64 processor); fewer go to classify_scalar()
+ByteClasses classify_sse2(const char* text, size_t n)
+{
+    if (n < 32)
+    {
+        return classify_scalar(text, n);
+    }
+    ByteClasses classes = {0, 0, 0};
+    for (int half = 0; half < 2; half++)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(text + 16 * half));
+
+        // ' ', and '\t' to '\r' by an unsigned range check: x - '\t' <= 4
+        __m128i control = _mm_sub_epi8(x, _mm_set1_epi8('\t'));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(4)), control));
+
+        __m128i symbol = _mm_cmpeq_epi8(x, _mm_set1_epi8(';'));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('/')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('*')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8(',')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('{')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('}')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('<')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('>')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('[')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8(']')));
+        symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(x, _mm_set1_epi8('.')));
+
+        // Letters of either case ((x | 0x20) - 'a' <= 25), digits (x - '0' <= 9) and '_'
+        __m128i letter = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i digit = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+        __m128i name = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(25)), letter),
+                                    _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit));
+        name = _mm_or_si128(name, _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+
+        uint32_t blanks = (uint32_t)_mm_movemask_epi8(blank);
+        uint32_t others = (uint32_t)_mm_movemask_epi8(_mm_or_si128(blank, symbol));
+        classes.blank |= blanks << (16 * half);
+        classes.word |= (~others & 0xFFFF) << (16 * half);
+        classes.name |= (uint32_t)_mm_movemask_epi8(name) << (16 * half);
+    }
+    return classes;
+}
+
+
+// Classify 32 bytes in one step with AVX2; fewer go to classify_scalar()
+__attribute__((target("avx2")))
+ByteClasses classify_avx2(const char* text, size_t n)
+{
+    if (n < 32)
+    {
+        return classify_scalar(text, n);
+    }
+    __m256i x = _mm256_loadu_si256((const __m256i*)text);
+
+    __m256i control = _mm256_sub_epi8(x, _mm256_set1_epi8('\t'));
+    __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8(4)), control));
+
+    __m256i symbol = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(';'));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('/')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('*')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(',')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('{')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('}')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('<')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('>')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('[')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(']')));
+    symbol = _mm256_or_si256(symbol, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('.')));
+
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i digit = _mm256_sub_epi8(x, _mm256_set1_epi8('0'));
+    __m256i name = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(25)), letter),
+                                   _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit));
+    name = _mm256_or_si256(name, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+
+    ByteClasses classes;
+    classes.blank = (uint32_t)_mm256_movemask_epi8(blank);
+    classes.word = ~(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(blank, symbol));
+    classes.name = (uint32_t)_mm256_movemask_epi8(name);
+    return classes;
+}
+#endif
+
+
+// Lex a large source on several threads and join the parts' tokens into one array, in order
+bool lex_parallel(const char* text, size_t size, TokenStream* ts, int threads)
+{
+    LexChunk* chunks = calloc(threads, sizeof(LexChunk));
+    pthread_t* workers = calloc(threads, sizeof(pthread_t));
+    if (chunks == NULL || workers == NULL)
+    {
+        printf("Error. Out of memory while storing tokens.\nExiting...\n");
+        exit(1);
+    }
+
+    // The lexer keeps nothing across a ';' or '}' (not even inside a path's brackets, where
+    // '}' ends an expansion), so the parts split after one have the tokens of the whole
+    int count = 0;
+    size_t begin = 0;
+    while (begin < size)
+    {
+        size_t end = size;
+        if (count + 1 < threads)
+        {
+            end = size / threads * (count + 1);
+            if (end <= begin)
+            {
+                end = begin + 1;
+            }
+            while (end < size && text[end - 1] != ';' && text[end - 1] != '}')
+            {
+                end++;
+            }
+        }
+        LexChunk* chunk = &chunks[count++];
+        chunk->text = text;
+        chunk->begin = begin;
+        chunk->end = end;
+        chunk->tokens = (TokenStream){.type = t_None, .source = text};
+        begin = end;
+    }
+
+    // The calling thread lexes the first part; a part whose thread cannot start is lexed after it
+    for (int i = 1; i < count; i++)
+    {
+        if (pthread_create(&workers[i], NULL, lex_worker, &chunks[i]) != 0)
+        {
+            workers[i] = 0;
+        }
+    }
+    lex_worker(&chunks[0]);
+    for (int i = 1; i < count; i++)
+    {
+        if (workers[i] != 0)
+        {
+            pthread_join(workers[i], NULL);
+        }
+        else
+        {
+            lex_worker(&chunks[i]);
+        }
+    }
+
+    // Intern the names part by part, each in order of first use, so that atoms are numbered as
+    // a single pass would number them; and make room for every token after those already read
+    int failed = -1;
+    size_t total = ts->count;
+    for (int i = 0; i < count; i++)
+    {
+        LexChunk* chunk = &chunks[i];
+        if (!chunk->valid)
+        {
+            failed = i;
+            break;
+        }
+        chunk->atoms = malloc((chunk->name_count + 1) * sizeof(uint32_t));
+        if (chunk->atoms == NULL)
+        {
+            printf("Error. Out of memory while storing directory names.\nExiting...\n");
+            exit(1);
+        }
+        for (uint32_t n = 0; n < chunk->name_count; n++)
+        {
+            const Token* first = &chunk->tokens.tokens[chunk->names[n]];
+            chunk->atoms[n] = intern_name(text + first->offset, first->length, true);
+        }
+        total += chunk->tokens.count;
+    }
+    if (failed < 0 && total > ts->capacity)
+    {
+        Token* tokens = realloc(ts->tokens, total * sizeof(Token));
+        if (tokens == NULL)
+        {
+            printf("Error. Out of memory while storing tokens.\nExiting...\n");
+            exit(1);
+        }
+        ts->tokens = tokens;
+        ts->capacity = total;
+    }
+
+    // Each part's thread then writes its tokens, with their atoms, into its place in the array
+    size_t at = ts->count;
+    for (int i = 0; i < count; i++)
+    {
+        chunks[i].out = failed < 0 ? ts->tokens + at : NULL;
+        at += chunks[i].tokens.count;
+    }
+    for (int i = 1; i < count; i++)
+    {
+        if (pthread_create(&workers[i], NULL, lex_finish, &chunks[i]) != 0)
+        {
+            workers[i] = 0;
+        }
+    }
+    lex_finish(&chunks[0]);
+    for (int i = 1; i < count; i++)
+    {
+        if (workers[i] != 0)
+        {
+            pthread_join(workers[i], NULL);
+        }
+        else
+        {
+            lex_finish(&chunks[i]);
+        }
+    }
+    if (failed >= 0)
+    {
+        // Lex the first invalid part again, on its own, for its error message
+        TokenStream scratch = {.type = t_None, .source = text};
+        lex_span(text, chunks[failed].begin, chunks[failed].end, &scratch, NULL);
+        free_tokens(&scratch);
+    }
+    else
+    {
+        ts->count = total;
+    }
+    free(chunks);
+    free(workers);
+    return failed < 0;
+}
+
+
+// Lex one part of a large source (run on its own thread)
+void* lex_worker(void* arg)
+{
+    LexChunk* chunk = arg;
+    chunk->valid = lex_span(chunk->text, chunk->begin, chunk->end, &chunk->tokens, chunk);
+    return NULL;
+}
+
+
+// Copy one part's tokens into the source's token array, giving names their atoms, and free the part
+void* lex_finish(void* arg)
+{
+    LexChunk* chunk = arg;
+    if (chunk->out != NULL)
+    {
+        for (size_t i = 0; i < chunk->tokens.count; i++)
+        {
+            Token token = chunk->tokens.tokens[i];
+            if (token.type == t_DirectoryName)
+            {
+                token.atom = chunk->atoms[token.atom];
+            }
+            chunk->out[i] = token;
+        }
+    }
+    free_tokens(&chunk->tokens);
+    free(chunk->names);
+    free(chunk->table);
+    free(chunk->atoms);
+    return NULL;
+}
+
+
+// Number of a directory name within a part, numbering it the first time it is seen there
+uint32_t chunk_name(LexChunk* chunk, const char* name, size_t len)
+{
+    // Keep the table at most three quarters full
+    if ((chunk->name_count + 1) * 4 > chunk->table_size * 3)
+    {
+        size_t size = chunk->table_size ? chunk->table_size * 2 : TABLE_INITIAL;
+        uint32_t* table = calloc(size, sizeof(uint32_t));
+        if (table == NULL)
+        {
+            printf("Error. Out of memory while storing directory names.\nExiting...\n");
+            exit(1);
+        }
+        for (uint32_t n = 0; n < chunk->name_count; n++)
+        {
+            const Token* first = &chunk->tokens.tokens[chunk->names[n]];
+            size_t slot = fold_hash(chunk->text + first->offset, first->length) & (size - 1);
+            while (table[slot] != 0)
+            {
+                slot = (slot + 1) & (size - 1);
+            }
+            table[slot] = n + 1;
+        }
+        free(chunk->table);
+        chunk->table = table;
+        chunk->table_size = size;
+    }
+
+    size_t mask = chunk->table_size - 1;
+    size_t slot = fold_hash(name, len) & mask;
+    for (; chunk->table[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const Token* first = &chunk->tokens.tokens[chunk->names[chunk->table[slot] - 1]];
+        const char* seen = chunk->text + first->offset;
+        size_t i = 0;
+        while (first->length == len && i < len && FOLD(seen[i]) == FOLD(name[i]))
+        {
+            i++;
+        }
+        if (first->length == len && i == len)
+        {
+            return chunk->table[slot] - 1;
+        }
+    }
+
+    if (chunk->name_count == chunk->name_capacity)
+    {
+        uint32_t capacity = chunk->name_capacity ? chunk->name_capacity * 2 : TABLE_INITIAL;
+        uint32_t* names = realloc(chunk->names, capacity * sizeof(uint32_t));
+        if (names == NULL)
+        {
+            printf("Error. Out of memory while storing directory names.\nExiting...\n");
+            exit(1);
+        }
+        chunk->names = names;
+        chunk->name_capacity = capacity;
+    }
+    // The name's token is the next one pushed
+    chunk->names[chunk->name_count] = chunk->tokens.count;
+    chunk->table[slot] = ++chunk->name_count;
+    return chunk->name_count - 1;
+}
+
+
+// Classify an identifier slice as a keyword or directory name and append its token; 'plain' tells
+// that the classifier found only letters, digits and '_' in it, so they need not be checked again
+bool lex_word(const char* text, size_t offset, size_t len, bool plain, TokenStream* ts, LexChunk* chunk)
+{
+    const char* word = text + offset;
+    if (len > PATH_MAX)
+    {
+        if (chunk != NULL)
+        {
+            return false;
+        }
+        report_error("Error. Identifier length cannot be greater than %d characters long.\nExiting...\n", PATH_MAX);
+        return false;
+    }
+    TokenType tokenType = t_None;
+    if (plain && isalpha((unsigned char)word[0]))
+    {
+        tokenType = checkIfKeyWord(word, len);
+        if (tokenType == t_None)
+        {
+            tokenType = t_DirectoryName;
+        }
+    }
+    else
+    {
+        tokenType = findTokenType(word, len);
+    }
+    if (tokenType == t_None)
+    {
+        if (chunk != NULL)
+        {
+            return false;
+        }
+        report_error("Error. Unrecognized character: \"%.*s\" in source file.\nExiting...\n", (int)len, word);
+        return false;
+    }
+    // Names are case-insensitive: the interner lowercases them
+    uint32_t atom = 0;
+    if (tokenType == t_DirectoryName)
+    {
+        atom = chunk != NULL ? chunk_name(chunk, word, len) : intern_name(word, len, true);
+    }
+    push_token(ts, tokenType, atom, offset, len);
+    return true;
+}
+
+
+// Append a token to the end of the token array, growing it when full
+bool push_token(TokenStream* ts, TokenType type, uint32_t atom, size_t offset, size_t length)
+{
+    if (ts->count == ts->capacity)
+    {
+        size_t capacity = ts->capacity ? ts->capacity * 2 : TOKENS_INITIAL;
+        Token* tokens = realloc(ts->tokens, capacity * sizeof(Token));
+        if (tokens == NULL)
+        {
+            printf("Error. Out of memory while storing tokens.\nExiting...\n");
+            exit(1);
+        }
+        ts->tokens = tokens;
+        ts->capacity = capacity;
+    }
+    ts->tokens[ts->count].type = type;
+    ts->tokens[ts->count].atom = atom;
+    ts->tokens[ts->count].offset = offset;
+    ts->tokens[ts->count].length = length;
+    ts->count++;
+    return true;
+}
+
+
+// Read the next token; returns its text (lexeme for directory names, token type otherwise)
+// or NULL once every token has been read
+const char* next_token(TokenStream* ts)
+{
+    if (ts->pos >= ts->count)
+    {
+        return NULL;
+    }
+    Token* token = &ts->tokens[ts->pos++];
+    ts->type = token->type;
+    ts->current = token->type == t_DirectoryName ? atom_name(token->atom) : tokenNames[token->type];
+    return ts->current;
+}
+
+
+// Write the token array to a file, one token per line, in the old 'code.lex' format
+bool dump_tokens(TokenStream* ts, const char* filename)
+{
+    FILE* fptr = fopen(filename, "w");
+    if (fptr == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < ts->count; i++)
+    {
+        Token* token = &ts->tokens[i];
+        fputs(token->type == t_DirectoryName ? atom_name(token->atom) : tokenNames[token->type], fptr);
+        fputc('\n', fptr);
+    }
+    return fclose(fptr) == 0;
+}
+
+
+// Release the token array
+void free_tokens(TokenStream* ts)
+{
+    free(ts->tokens);
+    free(ts->template_table);
+    ts->tokens = NULL;
+    ts->template_table = NULL;
+    ts->count = ts->capacity = ts->pos = 0;
+    ts->template_table_size = 0;
+}
+
+
+// Find token type: path or keyword
+TokenType findTokenType(const char *str, size_t len)
+{
+    TokenType keyword = checkIfKeyWord(str, len);
+    if (keyword != t_None)
+    {
+        return keyword;
+    }
+    bool alphaString_Check = checkIfAlphaString(str, len);
+    if(alphaString_Check == true)
+    {
+        return t_DirectoryName;
+    }
+    if (checkIfNumber(str, len))
+    {
+        return t_Number;
+    }
+    return t_None;
+}
+
+
+// Check if character string is made up of only decimal digits (as in a '[0..9]' range)
+bool checkIfNumber(const char *str, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (!isdigit((unsigned char)str[i]))
+        {
+            return false;
+        }
+    }
+    return len > 0;
+}
+
+
+// Check if character string is made up of only ASCII alphabet characters
+bool checkIfAlphaString(const char *str, size_t len)
+{
+    if(len > 0 && isalpha((unsigned char)str[0]))
+    {
+        for(size_t i = 1; i < len; i++)
+        {
+            if(!isalnum((unsigned char)str[i]) && !(str[i] == '_'))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+
+// Check to see if character is a bracket as defined by path_maker definition
+TokenType isbracket(char c)
+{
+    switch (c)
+    {
+        case '{': return t_LeftCurlyBrace;
+        case '}': return t_RightCurlyBrace;
+        case '<': return t_LessThanSign;
+        case '>': return t_GreaterThanSign;
+        case '[': return t_LeftSquareBracket;
+        case ']': return t_RightSquareBracket;
+    }
+    return t_None;
+}
+
+
+// Check if character string is a key word as defined in path_maker
+// The keyword set is fixed, so the length and first character select the only
+// candidate and at most one comparison of the remaining characters is needed
+TokenType checkIfKeyWord(const char *str, size_t len)
+{
+    switch (len)
+    {
+        case 2:
+            if (str[0] == 'g' && str[1] == 'o') return t_go;
+            if (str[0] == 'i' && str[1] == 'f') return t_if;
+            break;
+        case 3:
+            if (str[0] == 'u' && str[1] == 's' && str[2] == 'e') return t_use;
+            break;
+        case 4:
+            if (str[0] == 'm' && !memcmp(str + 1, "ake", 3)) return t_make;
+            break;
+        case 5:
+            if (str[0] == 'i' && !memcmp(str + 1, "fnot", 4)) return t_ifnot;
+            break;
+        case 6:
+            if (str[0] == 'r' && !memcmp(str + 1, "epeat", 5)) return t_repeat;
+            if (str[0] == 'd' && !memcmp(str + 1, "efine", 5)) return t_define;
+            break;
+    }
+    return t_None;
+}
+
+
+/************************************************************
+ * Parser: compiles the token array into a flat program.   *
+ * The command of an 'if'/'ifnot' is emitted right after it *
+ * and the jump past it is recorded once its closing brace  *
+ * is reached, so a false condition skips a block of any    *
+ * size or depth in one step.                               *
+ *                                                          *
+ *   program   := (statement | template)* EOF                *
+ *   statement := 'go' path ';' | 'make' path ';'           *
+ *              | 'if' path command | 'ifnot' path command  *
+ *              | 'repeat' Number 'as' DirectoryName        *
+ *                command                                   *
+ *              | 'use' DirectoryName 'at' path ';'         *
+ *   template  := 'define' DirectoryName                    *
+ *                '{' ('make' path ';')* '}'                *
+ *   command   := statement | '{' statement* '}'            *
+ *   path      := '<' ('*' '/')* ['*' | names] '>'          *
+ *   names     := name ('/' name)*                          *
+ *   name      := DirectoryName | first part*               *
+ *   first     := DirectoryName | choice                    *
+ *   part      := DirectoryName | Number | choice | range   *
+ *              | index                                     *
+ *   choice    := '{' DirectoryName                         *
+ *                (',' DirectoryName)* '}'                  *
+ *   range     := '[' Number '..' Number ']'                *
+ *   index     := '[' DirectoryName ']'                     *
+ *                                                          *
+ * The parts of a name follow each other without blanks.    *
+ * A make whose names have choices or ranges compiles to    *
+ * one op_expand instruction, which makes every expansion.  *
+ * An index names the variable of an enclosing repeat loop; *
+ * the loop's body is emitted once between an op_repeat and *
+ * an op_next that jumps back to its start.                 *
+ * A template emits no instructions: its make paths are     *
+ * merged into one subtree, which each op_use makes.        *
+ ************************************************************/
+
+
+// Parse the whole token array into a program; false on syntax error
+bool parse_program(TokenStream* ts, Program* program)
+{
+    ts->pos = 0;
+    while (ts->pos < ts->count)
+    {
+        // Templates are defined at the top level only, outside of any block or loop
+        bool parsed = ts->tokens[ts->pos].type == t_define ? parse_define(ts, program) : parse_statement(ts, program);
+        if (!parsed)
+        {
+            free_program(program);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Parse one 'go', 'make', 'if' or 'ifnot' statement and emit its instructions
+bool parse_statement(TokenStream* ts, Program* program)
+{
+    if (next_token(ts) == NULL)
+    {
+        report_error("Error. End of file reached without a command completing.\n");
+        return false;
+    }
+
+    OpCode op;
+    switch (ts->type)
+    {
+        case t_go:    op = op_go;    break;
+        case t_make:  op = op_make;  break;
+        case t_if:    op = op_if;    break;
+        case t_ifnot: op = op_ifnot; break;
+        case t_repeat: return parse_repeat(ts, program);
+        case t_use:    return parse_use(ts, program);
+        case t_define:
+            report_error("Error. Templates can only be defined outside of blocks and loops.\n");
+            return false;
+        default:
+            report_error("Error. Unexpected token '%s'. Expected a 'go', 'make', 'if', 'ifnot', 'repeat' or 'use' command.\n", ts->current);
+            return false;
+    }
+    // Keyword as written in the source, for error messages
+    const char* name = tokenNames[ts->type] + 2;
+
+    if (ts->pos >= ts->count || ts->tokens[ts->pos].type != t_LessThanSign)
+    {
+        report_error("Error. '%s' statement should be followed by a path name: '<PATH_NAME>'.\n", name);
+        return false;
+    }
+    size_t index = program->count;
+    Instruction* ins = emit(program, op);
+    if (!parse_path(ts, program, &ins->path))
+    {
+        return false;
+    }
+    // Other statements name a single path: loop indexes, but no expansions
+    if (op != op_make && path_expands(program, &ins->path))
+    {
+        report_error("Error. '%s' statement paths cannot have '{...}' or '[...]' expansions; only make statements can.\n", name);
+        return false;
+    }
+    if (ins->path.parts && op == op_make)
+    {
+        ins->op = op_expand;
+    }
+
+    if (op == op_go || op == op_make)
+    {
+        if (next_token(ts) == NULL || ts->type != t_EndOfLine)
+        {
+            report_error("Error. '%s' statement was not followed by a semicolon.\n", name);
+            return false;
+        }
+        return true;
+    }
+
+    // The command follows the condition; the array may move while it is emitted
+    if (!parse_command(ts, program))
+    {
+        return false;
+    }
+    if (program->count > UINT32_MAX)
+    {
+        report_error("Error. Too many statements in one program.\n");
+        return false;
+    }
+    program->code[index].end = program->count;
+    return true;
+}
+
+
+// Parse the command of an 'if'/'ifnot': a single statement or a block
+bool parse_command(TokenStream* ts, Program* program)
+{
+    if (ts->pos >= ts->count)
+    {
+        report_error("Error. End of file reached without a command completing.\n");
+        return false;
+    }
+    if (ts->tokens[ts->pos].type != t_LeftCurlyBrace)
+    {
+        return parse_statement(ts, program);
+    }
+
+    next_token(ts);
+    while (ts->pos < ts->count && ts->tokens[ts->pos].type != t_RightCurlyBrace)
+    {
+        if (!parse_statement(ts, program))
+        {
+            return false;
+        }
+    }
+    if (ts->pos >= ts->count)
+    {
+        report_error("Error. Left curly brace not closed with a right curly brace.\n");
+        return false;
+    }
+    next_token(ts);
+    return true;
+}
+
+
+// Parse a repeat loop, whose 'repeat' keyword has just been read, and emit its body
+// once between an op_repeat and an op_next
+bool parse_repeat(TokenStream* ts, Program* program)
+{
+    uint32_t times;
+    if (next_token(ts) == NULL || ts->type != t_Number)
+    {
+        report_error("Error. 'repeat' should be followed by a number of times: 'repeat N as NAME'.\n");
+        return false;
+    }
+    if (!parse_number(ts, &times))
+    {
+        return false;
+    }
+    // 'as' is only a keyword here, so it is still a valid directory name elsewhere
+    const Token* as = &ts->tokens[ts->pos];
+    if (next_token(ts) == NULL || ts->type != t_DirectoryName || as->length != 2 || memcmp(ts->source + as->offset, "as", 2)
+        || next_token(ts) == NULL || ts->type != t_DirectoryName)
+    {
+        report_error("Error. 'repeat %u' should be followed by 'as' and a loop variable name: 'repeat N as NAME'.\n", times);
+        return false;
+    }
+    if (ts->loop_depth == LOOP_DEPTH)
+    {
+        report_error("Error. Repeat loops cannot be nested more than %d deep.\n", LOOP_DEPTH);
+        return false;
+    }
+    uint32_t level = ts->loop_depth;
+    ts->loop_names[ts->loop_depth++] = ts->tokens[ts->pos - 1].atom;
+
+    size_t index = program->count;
+    Instruction* ins = emit(program, op_repeat);
+    ins->loop.times = times;
+    ins->loop.level = level;
+    // The body follows, as the command of an 'if'; the array may move while it is emitted
+    if (!parse_command(ts, program))
+    {
+        return false;
+    }
+    ts->loop_depth--;
+    ins = emit(program, op_next);
+    ins->end = index + 1;
+    ins->loop.times = times;
+    ins->loop.level = level;
+    if (program->count > UINT32_MAX)
+    {
+        report_error("Error. Too many statements in one program.\n");
+        return false;
+    }
+    program->code[index].end = program->count;
+    return true;
+}
+
+
+// Parse a template definition, 'define NAME { make <PATH>; ... }', and plan the subtree
+// its make statements create: each directory once, after its parent
+bool parse_define(TokenStream* ts, Program* program)
+{
+    next_token(ts);
+    uint32_t index;
+    if (next_token(ts) == NULL || ts->type != t_DirectoryName)
+    {
+        report_error("Error. 'define' should be followed by a template name: 'define NAME { make <PATH_NAME>; ... }'.\n");
+        return false;
+    }
+    if (find_template(program, ts->tokens[ts->pos - 1].atom, &index))
+    {
+        report_error("Error. Template '%s' is already defined.\n", ts->current);
+        return false;
+    }
+    Template template = {program->name_count, program->template_node_count, 0};
+    if (!push_name(program, ts->tokens[ts->pos - 1].atom))
+    {
+        return false;
+    }
+    if (next_token(ts) == NULL || ts->type != t_LeftCurlyBrace)
+    {
+        report_error("Error. Template '%s' should be followed by its make statements in curly braces: 'define NAME { make <PATH_NAME>; ... }'.\n",
+                     atom_name(program->names[template.name]));
+        return false;
+    }
+
+    while (next_token(ts) != NULL && ts->type != t_RightCurlyBrace)
+    {
+        if (ts->type != t_make)
+        {
+            report_error("Error. Unexpected token '%s'. Templates can only contain make statements.\n", ts->current);
+            return false;
+        }
+        if (ts->pos >= ts->count || ts->tokens[ts->pos].type != t_LessThanSign)
+        {
+            report_error("Error. 'make' statement should be followed by a path name: '<PATH_NAME>'.\n");
+            return false;
+        }
+        PathExpr path;
+        if (!parse_path(ts, program, &path))
+        {
+            return false;
+        }
+        if (path.parents > 0 || path.parts || path.count == 0)
+        {
+            report_error("Error. Template paths are relative to where the template is used, and can only contain directory names.\n");
+            return false;
+        }
+        if (next_token(ts) == NULL || ts->type != t_EndOfLine)
+        {
+            report_error("Error. 'make' statement was not followed by a semicolon.\n");
+            return false;
+        }
+
+        // Follow the path down the subtree, adding the directories it does not have yet
+        uint32_t parent = TEMPLATE_ROOT;
+        for (uint32_t i = 0; i < path.count; i++)
+        {
+            if (!template_child(ts, program, &template, parent, path.first + i, &parent))
+            {
+                return false;
+            }
+        }
+    }
+    if (ts->type != t_RightCurlyBrace)
+    {
+        report_error("Error. Left curly brace not closed with a right curly brace.\n");
+        return false;
+    }
+    return push_template(program, template);
+}
+
+
+// Hash of a template directory's parent and name, like a trie child's
+size_t template_hash(uint32_t parent, uint32_t atom)
+{
+    size_t hash = (size_t)parent * 31 + atom;
+    return (hash ^ (hash >> 17)) * 1099511628211ULL;
+}
+
+
+// Find the directory of the template being parsed with a parent and a name (an index into
+// the program's name array), adding it if the template has none yet; false when out of memory
+bool template_child(TokenStream* ts, Program* program, Template* template, uint32_t parent,
+                    uint32_t name, uint32_t* node)
+{
+    uint32_t first = template->first;
+    if ((template->count + 1) * 4 > ts->template_table_size * 3)
+    {
+        size_t size = ts->template_table_size ? ts->template_table_size * 2 : 64;
+        uint32_t* table = calloc(size, sizeof(uint32_t));
+        if (table == NULL)
+        {
+            report_error("Error. Out of memory while planning template '%s'.\n",
+                         atom_name(program->names[template->name]));
+            return false;
+        }
+        for (uint32_t i = 0; i < template->count; i++)
+        {
+            const TemplateNode* existing = &program->template_nodes[first + i];
+            size_t slot = template_hash(existing->parent, program->names[existing->name]) & (size - 1);
+            while (table[slot] != 0)
+            {
+                slot = (slot + 1) & (size - 1);
+            }
+            table[slot] = first + i + 1;
+        }
+        free(ts->template_table);
+        ts->template_table = table;
+        ts->template_table_size = size;
+    }
+
+    uint32_t atom = program->names[name];
+    size_t mask = ts->template_table_size - 1;
+    size_t slot = template_hash(parent, atom) & mask;
+    for (; ts->template_table[slot] > first; slot = (slot + 1) & mask)
+    {
+        const TemplateNode* existing = &program->template_nodes[ts->template_table[slot] - 1];
+        if (existing->parent == parent && program->names[existing->name] == atom)
+        {
+            *node = ts->template_table[slot] - 1 - first;
+            return true;
+        }
+    }
+    if (!push_template_node(program, (TemplateNode){parent, name, 1}))
+    {
+        return false;
+    }
+    if (parent != TEMPLATE_ROOT)
+    {
+        program->template_nodes[first + parent].leaf = 0;
+    }
+    ts->template_table[slot] = first + template->count + 1;
+    *node = template->count++;
+    return true;
+}
+
+
+// Parse a use statement, 'use NAME at <PATH>;', whose 'use' keyword has just been read
+bool parse_use(TokenStream* ts, Program* program)
+{
+    uint32_t index;
+    if (next_token(ts) == NULL || ts->type != t_DirectoryName)
+    {
+        report_error("Error. 'use' should be followed by a template name: 'use NAME at <PATH_NAME>;'.\n");
+        return false;
+    }
+    if (!find_template(program, ts->tokens[ts->pos - 1].atom, &index))
+    {
+        report_error("Error. Template '%s' is not defined. Templates must be defined before they are used.\n", ts->current);
+        return false;
+    }
+    // 'at' is only a keyword here, so it is still a valid directory name elsewhere
+    const Token* at = &ts->tokens[ts->pos];
+    if (next_token(ts) == NULL || ts->type != t_DirectoryName || at->length != 2 || memcmp(ts->source + at->offset, "at", 2)
+        || ts->pos >= ts->count || ts->tokens[ts->pos].type != t_LessThanSign)
+    {
+        report_error("Error. 'use NAME' should be followed by 'at' and a path name: 'use NAME at <PATH_NAME>;'.\n");
+        return false;
+    }
+    Instruction* ins = emit(program, op_use);
+    ins->end = index;
+    if (!parse_path(ts, program, &ins->path))
+    {
+        return false;
+    }
+    if (path_expands(program, &ins->path))
+    {
+        report_error("Error. 'use' statement paths cannot have '{...}' or '[...]' expansions; only make statements can.\n");
+        return false;
+    }
+    if (next_token(ts) == NULL || ts->type != t_EndOfLine)
+    {
+        report_error("Error. 'use' statement was not followed by a semicolon.\n");
+        return false;
+    }
+    return true;
+}
+
+
+// Find a template by the atom of its name
+bool find_template(const Program* program, uint32_t atom, uint32_t* index)
+{
+    for (size_t i = 0; i < program->template_count; i++)
+    {
+        if (program->names[program->templates[i].name] == atom)
+        {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Check whether a parsed path stands for more than one path: a part with several values
+bool path_expands(const Program* program, const PathExpr* path)
+{
+    for (uint32_t i = 0; path->parts && i < path->count; i++)
+    {
+        if (part_size(&program->parts[path->first + i]) != 1)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Check a given path's syntactic validity and collect its parts
+// The next token must be the opening '<'. The path's 'parts' is set when a directory name
+// has expansions or loop indexes; it then refers to the program's parts, not its names.
+bool parse_path(TokenStream* ts, Program* program, PathExpr* path)
+{
+    path->parents = 0;
+    path->count = 0;
+    path->first = program->name_count;
+    path->parts = 0;
+
+    next_token(ts);
+    if (next_token(ts) == NULL)
+    {
+        report_error("Error. Less than sign was not followed by a valid path name: <INVALID_PATH_NAME\n");
+        return false;
+    }
+
+    // Operator '*' can be used multiple times, but only before any directory name
+    while (ts->type == t_Astrix)
+    {
+        path->parents++;
+        if (next_token(ts) == NULL)
+        {
+            report_error("Error. Missing greater than sign after path name: <INVALID_PATH_NAME\n");
+            return false;
+        }
+        if (ts->type == t_GreaterThanSign)
+        {
+            return true;
+        }
+        if (ts->type != t_ForwardSlash || next_token(ts) == NULL)
+        {
+            report_error("Error. Less than sign was not followed by a valid path name: <INVALID_PATH_NAME\n");
+            return false;
+        }
+    }
+
+    // Operator '/' cannot be used at the beginning or the end of a path
+    while (true)
+    {
+        if (!parse_name(ts, program, path))
+        {
+            return false;
+        }
+        if (next_token(ts) == NULL)
+        {
+            report_error("Error. Missing greater than sign after path name: <INVALID_PATH_NAME\n");
+            return false;
+        }
+        if (ts->type == t_GreaterThanSign)
+        {
+            return true;
+        }
+        if (ts->type != t_ForwardSlash || next_token(ts) == NULL)
+        {
+            report_error("Error. Missing greater than sign after path name: <INVALID_PATH_NAME\n");
+            return false;
+        }
+    }
+}
+
+
+// Parse one directory name of a path, whose first token has just been read: a plain
+// name, or adjacent parts with expansions or loop indexes such as 'shard[0000..4095]',
+// '{src,test}' or 'tenant[i]'
+bool parse_name(TokenStream* ts, Program* program, PathExpr* path)
+{
+    // Plain names are the common case, and stay in the name array
+    if (ts->type == t_DirectoryName && !name_continues(ts) && !path->parts)
+    {
+        path->count++;
+        return push_name(program, ts->tokens[ts->pos - 1].atom);
+    }
+    if (ts->type != t_DirectoryName && ts->type != t_LeftCurlyBrace)
+    {
+        report_error("Error. Less than sign was not followed by a valid path name: <INVALID_PATH_NAME\n");
+        return false;
+    }
+
+    // The first expansion turns the names read so far into parts
+    if (!path->parts)
+    {
+        path->parts = 1;
+        uint32_t names = path->first;
+        path->first = program->part_count;
+        for (uint32_t i = 0; i < path->count; i++)
+        {
+            if (!push_part(program, (PathPart){part_name, 0, names + i, 0, 0}))
+            {
+                return false;
+            }
+        }
+    }
+
+    bool joined = false;
+    do
+    {
+        PathPart part = {part_name, joined, program->name_count, 0, 0};
+        if (joined)
+        {
+            next_token(ts);
+        }
+        if (ts->type == t_DirectoryName)
+        {
+            if (!push_name(program, ts->tokens[ts->pos - 1].atom))
+            {
+                return false;
+            }
+        }
+        else if (ts->type == t_Number && joined)
+        {
+            // A fixed number after an expansion is a range of one
+            part.kind = part_range;
+            if (!parse_number(ts, &part.first))
+            {
+                return false;
+            }
+            part.last = part.first;
+            part.width = ts->tokens[ts->pos - 1].length;
+        }
+        else if (ts->type == t_LeftCurlyBrace)
+        {
+            // '{' DirectoryName (',' DirectoryName)* '}'
+            part.kind = part_choice;
+            do
+            {
+                if (next_token(ts) == NULL || ts->type != t_DirectoryName)
+                {
+                    report_error("Error. Expected a directory name in a '{...}' expansion: <INVALID_PATH_NAME\n");
+                    return false;
+                }
+                if (!push_name(program, ts->tokens[ts->pos - 1].atom))
+                {
+                    return false;
+                }
+            }
+            while (next_token(ts) != NULL && ts->type == t_Comma);
+            if (ts->type != t_RightCurlyBrace)
+            {
+                report_error("Error. A '{...}' expansion was not closed with a right curly brace: <INVALID_PATH_NAME\n");
+                return false;
+            }
+            part.last = program->name_count;
+        }
+        else if (ts->type == t_LeftSquareBracket && joined && ts->pos < ts->count
+                 && ts->tokens[ts->pos].type == t_DirectoryName)
+        {
+            if (!parse_index(ts, &part))
+            {
+                return false;
+            }
+        }
+        else if (ts->type == t_LeftSquareBracket && joined)
+        {
+            // '[' Number '..' Number ']', zero-padded when either bound is
+            part.kind = part_range;
+            size_t bounds = ts->pos;
+            if (next_token(ts) == NULL || ts->type != t_Number || !parse_number(ts, &part.first)
+                || next_token(ts) == NULL || ts->type != t_Range
+                || next_token(ts) == NULL || ts->type != t_Number || !parse_number(ts, &part.last)
+                || next_token(ts) == NULL || ts->type != t_RightSquareBracket)
+            {
+                report_error("Error. Expected a range such as '[0..9]' after a directory name: <INVALID_PATH_NAME\n");
+                return false;
+            }
+            const Token* low = &ts->tokens[bounds];
+            const Token* high = &ts->tokens[bounds + 2];
+            bool padded = (low->length > 1 && ts->source[low->offset] == '0')
+                          || (high->length > 1 && ts->source[high->offset] == '0');
+            part.width = padded ? (low->length > high->length ? low->length : high->length) : 0;
+        }
+        else
+        {
+            // Directory names start with a letter, so neither can a range
+            report_error("Error. Directory names must start with a letter or a '{...}' expansion: <INVALID_PATH_NAME\n");
+            return false;
+        }
+        if (!push_part(program, part))
+        {
+            return false;
+        }
+        path->count++;
+        joined = true;
+    }
+    while (name_continues(ts));
+    return true;
+}
+
+
+// Parse a loop index, '[' DirectoryName ']', whose '[' has just been read: the variable
+// of the innermost enclosing repeat loop with that name
+bool parse_index(TokenStream* ts, PathPart* part)
+{
+    next_token(ts);
+    uint32_t atom = ts->tokens[ts->pos - 1].atom;
+    uint32_t level = ts->loop_depth;
+    while (level > 0 && ts->loop_names[level - 1] != atom)
+    {
+        level--;
+    }
+    if (level == 0)
+    {
+        report_error("Error. '%s' in '[%s]' is not the variable of an enclosing repeat loop: <INVALID_PATH_NAME\n", ts->current, ts->current);
+        return false;
+    }
+    if (next_token(ts) == NULL || ts->type != t_RightSquareBracket)
+    {
+        report_error("Error. Expected ']' after the loop variable '%s': <INVALID_PATH_NAME\n", atom_name(atom));
+        return false;
+    }
+    part->kind = part_index;
+    part->first = level - 1;
+    return true;
+}
+
+
+// Check whether the token after the one just read continues the same directory name:
+// it follows with no blank in between, and is a name, a number or an expansion
+bool name_continues(const TokenStream* ts)
+{
+    if (ts->pos >= ts->count)
+    {
+        return false;
+    }
+    const Token* last = &ts->tokens[ts->pos - 1];
+    const Token* next = &ts->tokens[ts->pos];
+    return next->offset == last->offset + last->length
+           && (next->type == t_DirectoryName || next->type == t_Number
+               || next->type == t_LeftCurlyBrace || next->type == t_LeftSquareBracket);
+}
+
+
+// Read the value of the number token just read
+bool parse_number(TokenStream* ts, uint32_t* value)
+{
+    const Token* token = &ts->tokens[ts->pos - 1];
+    uint64_t number = 0;
+    for (uint32_t i = 0; i < token->length && number <= UINT32_MAX; i++)
+    {
+        number = number * 10 + (ts->source[token->offset + i] - '0');
+    }
+    if (number > UINT32_MAX)
+    {
+        report_error("Error. Number %.*s is too large.\n", (int)token->length, ts->source + token->offset);
+        return false;
+    }
+    *value = number;
+    return true;
+}
+
+
+// Append a directory name to the program's name array
+bool push_name(Program* program, uint32_t atom)
+{
+    if (program->name_count == program->name_capacity)
+    {
+        size_t capacity = program->name_capacity ? program->name_capacity * 2 : TOKENS_INITIAL;
+        uint32_t* names = realloc(program->names, capacity * sizeof(uint32_t));
+        if (names == NULL)
+        {
+            report_error("Error. Out of memory while parsing a path.\n");
+            return false;
+        }
+        program->names = names;
+        program->name_capacity = capacity;
+    }
+    program->names[program->name_count++] = atom;
+    return true;
+}
+
+
+// Append a part of an expanding path to the program's part array
+bool push_part(Program* program, PathPart part)
+{
+    if (program->part_count == program->part_capacity)
+    {
+        size_t capacity = program->part_capacity ? program->part_capacity * 2 : 64;
+        PathPart* parts = realloc(program->parts, capacity * sizeof(PathPart));
+        if (parts == NULL)
+        {
+            report_error("Error. Out of memory while parsing a path.\n");
+            return false;
+        }
+        program->parts = parts;
+        program->part_capacity = capacity;
+    }
+    program->parts[program->part_count++] = part;
+    return true;
+}
+
+
+// Append a template to the program's template array
+bool push_template(Program* program, Template template)
+{
+    if (program->template_count == program->template_capacity)
+    {
+        size_t capacity = program->template_capacity ? program->template_capacity * 2 : 16;
+        Template* templates = realloc(program->templates, capacity * sizeof(Template));
+        if (templates == NULL)
+        {
+            report_error("Error. Out of memory while parsing a template.\n");
+            return false;
+        }
+        program->templates = templates;
+        program->template_capacity = capacity;
+    }
+    program->templates[program->template_count++] = template;
+    return true;
+}
+
+
+// Append a directory of a template's subtree to the program's template node array
+bool push_template_node(Program* program, TemplateNode node)
+{
+    if (program->template_node_count == program->template_node_capacity)
+    {
+        size_t capacity = program->template_node_capacity ? program->template_node_capacity * 2 : 64;
+        TemplateNode* nodes = realloc(program->template_nodes, capacity * sizeof(TemplateNode));
+        if (nodes == NULL)
+        {
+            report_error("Error. Out of memory while parsing a template.\n");
+            return false;
+        }
+        program->template_nodes = nodes;
+        program->template_node_capacity = capacity;
+    }
+    program->template_nodes[program->template_node_count++] = node;
+    return true;
+}
+
+
+// Append a zeroed instruction to the program, growing it when full
+Instruction* emit(Program* program, OpCode op)
+{
+    if (program->count == program->capacity)
+    {
+        size_t capacity = program->capacity ? program->capacity * 2 : TOKENS_INITIAL;
+        Instruction* code = realloc(program->code, capacity * sizeof(Instruction));
+        if (code == NULL)
+        {
+            printf("Error. Out of memory while compiling the program.\nExiting...\n");
+            exit(1);
+        }
+        program->code = code;
+        program->capacity = capacity;
+    }
+    Instruction* ins = &program->code[program->count++];
+    memset(ins, 0, sizeof(Instruction));
+    ins->op = op;
+    return ins;
+}
+
+
+// Release a program, or unmap it if it was loaded from a .pmc file
+void free_program(Program* program)
+{
+    if (program->mapping != NULL)
+    {
+        munmap(program->mapping, program->mapping_size);
+    }
+    else
+    {
+        free(program->code);
+        free(program->names);
+        free(program->parts);
+        free(program->templates);
+        free(program->template_nodes);
+    }
+    free(program->atoms);
+    memset(program, 0, sizeof(Program));
+}
+
+
+/*********************************************************************
+ * Arenas: things made in large numbers and released together -      *
+ * path nodes, the characters of names, the nodes of a make batch -  *
+ * are cut from large blocks by bumping a pointer, with no malloc,   *
+ * free or zeroing per object. A batch's arena is reset after each   *
+ * flush and its blocks are reused by the next batch.                *
+ *********************************************************************/
+
+
+// Allocate 'size' bytes, not zeroed, from an arena; exits if memory runs out
+void* arena_alloc(Arena* arena, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    while (arena->current == NULL || arena->used + size > arena->current->size)
+    {
+        // Move on to the next kept block, or add one at the end
+        ArenaBlock* next = arena->current != NULL ? arena->current->next : arena->first;
+        if (next == NULL)
+        {
+            size_t bytes = size > ARENA_BLOCK - ARENA_HEADER ? size : ARENA_BLOCK - ARENA_HEADER;
+            next = malloc(ARENA_HEADER + bytes);
+            if (next == NULL)
+            {
+                printf("Error. Out of memory.\nExiting...\n");
+                exit(1);
+            }
+            next->next = NULL;
+            next->size = bytes;
+            if (arena->current != NULL)
+            {
+                arena->current->next = next;
+            }
+            else
+            {
+                arena->first = next;
+            }
+        }
+        arena->current = next;
+        arena->used = 0;
+    }
+    void* memory = (char*)arena->current + ARENA_HEADER + arena->used;
+    arena->used += size;
+    return memory;
+}
+
+
+// Give back everything allocated from an arena, keeping its blocks for reuse
+void arena_reset(Arena* arena)
+{
+    arena->current = NULL;
+    arena->used = 0;
+}
+
+
+// Release an arena's blocks
+void arena_free(Arena* arena)
+{
+    while (arena->first != NULL)
+    {
+        ArenaBlock* next = arena->first->next;
+        free(arena->first);
+        arena->first = next;
+    }
+    arena_reset(arena);
+}
+
+
+/*********************************************************************
+ * Paths: directory names are interned once by the lexer, and every *
+ * resolved path is a node in one trie of (parent, name) pairs. '*'  *
+ * is a move to the parent node, two paths are equal when their      *
+ * nodes are, and the existence cache lives in the nodes themselves. *
+ * Path strings are only built when a system call or message needs   *
+ * one.                                                              *
+ *********************************************************************/
+
+
+// Take the lock on the interner and the trie tables, when scripts run in parallel
+void names_lock(void)
+{
+    if (names_shared)
+    {
+        pthread_mutex_lock(&names_mutex);
+    }
+}
+
+
+// Release the lock taken by names_lock()
+void names_unlock(void)
+{
+    if (names_shared)
+    {
+        pthread_mutex_unlock(&names_mutex);
+    }
+}
+
+
+// Hash a name (FNV-1a)
+size_t name_hash(const char* name, size_t len)
+{
+    size_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (unsigned char)name[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+// Hash a name as if it were lowercased
+size_t fold_hash(const char* name, size_t len)
+{
+    size_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (unsigned char)FOLD(name[i])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+// Return the atom of a name, adding it to the interner the first time it is seen
+uint32_t intern(const char* name, size_t len)
+{
+    return intern_name(name, len, false);
+}
+
+
+// Intern a name; with 'fold' the name is lowercased first, without copying it to do so
+uint32_t intern_name(const char* name, size_t len, bool fold)
+{
+    names_lock();
+    uint32_t atom = intern_locked(name, len, fold);
+    names_unlock();
+    return atom;
+}
+
+
+// Body of intern_name(), called with the names lock held
+uint32_t intern_locked(const char* name, size_t len, bool fold)
+{
+    // Keep the table at most three quarters full
+    if ((interner.count + 1) * 4 > interner.size * 3)
+    {
+        size_t size = interner.size ? interner.size * 2 : TABLE_INITIAL;
+        uint32_t* table = calloc(size, sizeof(uint32_t));
+        if (table == NULL)
+        {
+            printf("Error. Out of memory while storing directory names.\nExiting...\n");
+            exit(1);
+        }
+        for (uint32_t atom = 0; atom < interner.count; atom++)
+        {
+            size_t slot = name_hash(atom_at(atom)->name, atom_at(atom)->len) & (size - 1);
+            while (table[slot] != 0)
+            {
+                slot = (slot + 1) & (size - 1);
+            }
+            table[slot] = atom + 1;
+        }
+        free(interner.table);
+        interner.table = table;
+        interner.size = size;
+    }
+
+    // Same hash as name_hash() over the lowercased name
+    size_t hash = fold ? fold_hash(name, len) : name_hash(name, len);
+
+    size_t mask = interner.size - 1;
+    size_t slot = hash & mask;
+    for (; interner.table[slot] != 0; slot = (slot + 1) & mask)
+    {
+        Atom* atom = atom_at(interner.table[slot] - 1);
+        if (atom->len != len)
+        {
+            continue;
+        }
+        size_t i = 0;
+        if (fold)
+        {
+            while (i < len && atom->name[i] == FOLD(name[i]))
+            {
+                i++;
+            }
+        }
+        else if (!memcmp(atom->name, name, len))
+        {
+            i = len;
+        }
+        if (i == len)
+        {
+            return interner.table[slot] - 1;
+        }
+    }
+
+    Atom** chunk = &interner.chunks[interner.count >> ATOM_CHUNK_BITS];
+    if (*chunk == NULL)
+    {
+        *chunk = malloc(sizeof(Atom) << ATOM_CHUNK_BITS);
+        if (*chunk == NULL)
+        {
+            printf("Error. Out of memory while storing directory names.\nExiting...\n");
+            exit(1);
+        }
+    }
+    Atom* atom = atom_at(interner.count);
+    char* copy = arena_alloc(&interner.text, len + 1);
+    for (size_t i = 0; i < len; i++)
+    {
+        copy[i] = fold ? FOLD(name[i]) : name[i];
+    }
+    copy[len] = '\0';
+    atom->name = copy;
+    atom->len = len;
+    interner.table[slot] = ++interner.count;
+    return interner.count - 1;
+}
+
+
+// Entry of an atom
+Atom* atom_at(uint32_t atom)
+{
+    return &interner.chunks[atom >> ATOM_CHUNK_BITS][atom & ((1u << ATOM_CHUNK_BITS) - 1)];
+}
+
+
+// Name of an atom
+const char* atom_name(uint32_t atom)
+{
+    return atom_at(atom)->name;
+}
+
+
+// Hash slot of a (parent, atom) pair in the trie's table
+size_t child_hash(const PathNode* parent, uint32_t atom)
+{
+    size_t hash = (size_t)(uintptr_t)parent * 31 + atom;
+    return (hash ^ (hash >> 17)) * 1099511628211ULL;
+}
+
+
+// The root node '/', which is its own parent
+PathNode* path_root(void)
+{
+    if (trie.root.parent == NULL)
+    {
+        trie.root.parent = &trie.root;
+        trie.root.state = PATH_DIRECTORY;
+    }
+    return &trie.root;
+}
+
+
+// Return the child of a path node with the given name, adding it if needed
+PathNode* path_child(PathNode* parent, uint32_t atom)
+{
+    names_lock();
+    PathNode* node = path_child_locked(parent, atom);
+    names_unlock();
+    return node;
+}
+
+
+// Body of path_child(), called with the names lock held
+PathNode* path_child_locked(PathNode* parent, uint32_t atom)
+{
+    // Keep the table at most three quarters full
+    if ((trie.count + 1) * 4 > trie.size * 3)
+    {
+        size_t size = trie.size ? trie.size * 2 : TABLE_INITIAL;
+        PathNode** table = calloc(size, sizeof(PathNode*));
+        if (table == NULL)
+        {
+            printf("Error. Out of memory while storing paths.\nExiting...\n");
+            exit(1);
+        }
+        for (size_t i = 0; i < trie.size; i++)
+        {
+            PathNode* node = trie.table[i];
+            if (node != NULL)
+            {
+                size_t slot = child_hash(node->parent, node->atom) & (size - 1);
+                while (table[slot] != NULL)
+                {
+                    slot = (slot + 1) & (size - 1);
+                }
+                table[slot] = node;
+            }
+        }
+        free(trie.table);
+        trie.table = table;
+        trie.size = size;
+    }
+
+    size_t mask = trie.size - 1;
+    size_t slot = child_hash(parent, atom) & mask;
+    for (; trie.table[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        PathNode* node = trie.table[slot];
+        if (node->parent == parent && node->atom == atom)
+        {
+            return node;
+        }
+    }
+
+    PathNode* node = arena_alloc(&trie.nodes, sizeof(PathNode));
+    *node = (PathNode){.parent = parent, .atom = atom, .depth = parent->depth + 1,
+                       .len = parent->len + 1 + atom_at(atom)->len, .state = PATH_UNKNOWN};
+    trie.table[slot] = node;
+    trie.count++;
+    return node;
+}
+
+
+// Find the node of an absolute path string; its names are taken as they are
+PathNode* path_from_string(const char* folder)
+{
+    PathNode* node = path_root();
+    while (*folder != '\0')
+    {
+        size_t len = strcspn(folder, "/");
+        if (len > 0)
+        {
+            node = path_child(node, intern(folder, len));
+        }
+        folder += len;
+        while (*folder == '/')
+        {
+            folder++;
+        }
+    }
+    return node;
+}
+
+
+// Write the absolute path of a node into 'folder' (at least node->len + 2 bytes)
+char* path_string(const PathNode* node, char* folder)
+{
+    if (node->depth == 0)
+    {
+        strcpy(folder, "/");
+        return folder;
+    }
+    folder[node->len] = '\0';
+    for (; node->depth > 0; node = node->parent)
+    {
+        const Atom* atom = atom_at(node->atom);
+        memcpy(folder + node->len - atom->len, atom->name, atom->len);
+        folder[node->len - atom->len - 1] = '/';
+    }
+    return folder;
+}
+
+
+// Record that a directory exists, and with it every one of its parents
+void cache_mark_exists(PathNode* node)
+{
+    for (; node->state < PATH_DIRECTORY; node = node->parent)
+    {
+        node->state = PATH_DIRECTORY;
+    }
+}
+
+
+// Record that this process created a directory
+void cache_mark_created(PathNode* node)
+{
+    cache_mark_exists(node->parent);
+    node->state = PATH_CREATED;
+}
+
+
+// Check whether a path is an existing directory, using the cache as the policy allows
+// ('--cache trust' answers from memory for every path this process has made or looked at,
+// assuming nothing else changes the disk while it runs; '--cache verify' always stats)
+bool path_exists(Executor* ex, PathNode* node)
+{
+    if (ex->planning)
+    {
+        return plan_exists(ex, node);
+    }
+    PathState seen = node->state;
+    if (ex->trust_cache && seen != PATH_UNKNOWN)
+    {
+        return seen >= PATH_DIRECTORY;
+    }
+    struct stat sb;
+    bool exists = path_stat(ex, node, &sb) == 0 && S_ISDIR(sb.st_mode);
+    if (exists)
+    {
+        cache_mark_exists(node);
+    }
+    else
+    {
+        // Unless another script has created the path since it was looked at
+        atomic_compare_exchange_strong(&node->state, &seen, PATH_MISSING);
+    }
+    return exists;
+}
+
+
+// Stat a path relative to its parent's open directory
+int path_stat(Executor* ex, PathNode* node, struct stat* sb)
+{
+    COUNT(stat_calls, 1);
+    if (node->depth == 0)
+    {
+        return stat("/", sb);
+    }
+    int parent = dir_open(ex, node->parent);
+    if (parent < 0)
+    {
+        return -1;
+    }
+    return fstatat(parent, atom_name(node->atom), sb, 0);
+}
+
+
+// Return an open directory for a path, opening it relative to its parent if it is not
+// cached; -1 with errno set if it cannot be opened. The descriptor belongs to the cache,
+// and stays open at least until another path is opened.
+int dir_open(Executor* ex, PathNode* node)
+{
+    size_t slot = node->depth % DIR_CACHE_DEPTH;
+    if (ex->dir_nodes[slot] == node)
+    {
+        return ex->dir_fds[slot];
+    }
+    int fd;
+    if (node->depth == 0)
+    {
+        fd = open("/", O_PATH | O_DIRECTORY | O_CLOEXEC);
+    }
+    else
+    {
+        int parent = dir_open(ex, node->parent);
+        if (parent < 0)
+        {
+            return -1;
+        }
+        fd = openat(parent, atom_name(node->atom), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    }
+    COUNT(open_calls, 1);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (ex->dir_nodes[slot] != NULL)
+    {
+        close(ex->dir_fds[slot]);
+    }
+    ex->dir_nodes[slot] = node;
+    ex->dir_fds[slot] = fd;
+    return fd;
+}
+
+
+// Close every cached directory, so that nothing opened for one script outlives it
+void dir_cache_clear(Executor* ex)
+{
+    for (size_t i = 0; i < DIR_CACHE_DEPTH; i++)
+    {
+        if (ex->dir_nodes[i] != NULL)
+        {
+            close(ex->dir_fds[i]);
+            ex->dir_nodes[i] = NULL;
+        }
+    }
+}
+
+
+// Build the path string of a node in the executor's buffer, valid until the next call
+const char* path_text(Executor* ex, const PathNode* node)
+{
+    if (node->len + 1 > ex->text_size)
+    {
+        size_t size = ex->text_size ? ex->text_size : PATH_MAX;
+        while (size < node->len + 1)
+        {
+            size *= 2;
+        }
+        char* text = realloc(ex->text, size);
+        if (text == NULL)
+        {
+            printf("Error. Out of memory while building a path.\nExiting...\n");
+            exit(1);
+        }
+        ex->text = text;
+        ex->text_size = size;
+    }
+    return path_string(node, ex->text);
+}
+
+
+// Resolve a path expression of a program against the current directory
+// The current directory itself is never modified
+PathNode* resolve_path(Executor* ex, const PathExpr* path)
+{
+    // Each '*' moves to the parent; the root is its own parent
+    const Program* program = ex->program;
+    PathNode* node = ex->cwd;
+    for (uint32_t i = 0; i < path->parents; i++)
+    {
+        node = node->parent;
+    }
+    if (path->parts)
+    {
+        // Names with loop indexes, built for the loops' current iteration. A name longer
+        // than NAME_MAX is cut to NAME_MAX + 1 characters, so it still names no directory.
+        char name[NAME_MAX + 1];
+        size_t len;
+        for (uint32_t i = 0; i < path->count; )
+        {
+            i = build_name(ex, program->parts + path->first, path->count, NULL, i, name, &len);
+            node = path_child(node, intern(name, len));
+        }
+        return node;
+    }
+    const uint32_t* names = program->names + path->first;
+    for (uint32_t i = 0; i < path->count; i++)
+    {
+        node = path_child(node, program->atoms ? program->atoms[names[i]] : names[i]);
+    }
+    return node;
+}
+
+
+/*****************************************************
+ * Executor: runs the program's instructions in turn *
+ *****************************************************/
+
+
+// Execute the instructions in order; a false 'if'/'ifnot' jumps past its command,
+// and the end of a repeat loop's body jumps back to its start until the loop is done
+void translate(const Program* program, Executor* ex)
+{
+    size_t pc = 0;
+    size_t executed = 0;
+    ex->program = program;
+    ex->guard_count = 0;
+    for (; pc < program->count; executed++)
+    {
+        const Instruction* ins = &program->code[pc];
+        ex->statement = ins;
+        // Leave the commands of the if/ifnot statements this instruction is not part of
+        while (ex->guard_count > 0 && !(ex->guards[ex->guard_count - 1].start < pc
+                                        && pc < ex->guards[ex->guard_count - 1].end))
+        {
+            ex->guard_count--;
+        }
+        switch (ins->op)
+        {
+            case op_go:    go(ins, ex);   pc++; break;
+            case op_make:  make(ins, ex); pc++; break;
+            case op_if:    pc = ifPath_maker(ins, ex) ? pc + 1 : ins->end; break;
+            case op_ifnot: pc = ifnot(ins, ex) ? pc + 1 : ins->end;        break;
+            case op_expand: expand(ins, ex); pc++; break;
+            case op_repeat:
+                ex->loop[ins->loop.level] = 0;
+                pc = ins->loop.times > 0 ? pc + 1 : ins->end;
+                break;
+            case op_next:
+                pc = ++ex->loop[ins->loop.level] < ins->loop.times ? ins->end : pc + 1;
+                break;
+            case op_use: use(ins, ex); pc++; break;
+        }
+    }
+    COUNT(executed, executed);
+}
+
+
+// Execute a go statement: change the current directory if the path exists
+void go(const Instruction* ins, Executor* ex)
+{
+    // Queued makes may create the path this statement looks at
+    flush_makes(ex);
+    PathNode* target = resolve_path(ex, &ins->path);
+    const char* folder = path_text(ex, target);
+    if (statement_exists(ex, target, folder)) {
+        say(ex, "Path exists. Go statement executed.\n");
+        ex->cwd = target;
+        say(ex, "Current directory is now changed to: %s\n", folder);
+    } else {
+        say(ex, "Path: %s does not exist. Go statement cannot be executed\n", folder);
+        COUNT(failed_gos, 1);
+    }
+}
+
+
+// Execute a make statement: create every missing directory of the path
+void make(const Instruction* ins, Executor* ex)
+{
+    make_target(ex, resolve_path(ex, &ins->path), false);
+}
+
+
+// Create every missing directory of a make statement's resolved path; 'queue' adds it to
+// the batch even when makes run one at a time, so that a subtree is created in one pass
+void make_target(Executor* ex, PathNode* target, bool queue)
+{
+    const char* folder = path_text(ex, target);
+    if (ex->planning)
+    {
+        plan_make(ex, target, folder);
+        return;
+    }
+    // A make applied by the last run is not repeated if its directory is still there, nor
+    // with '--cache trust' one whose directory is known to exist; with makes queued, it
+    // waits for them, so that the statements are reported in order
+    uint64_t key = ex->journal ? journal_key(ex, folder) : 0;
+    if (ex->batch.count == 0
+        && ((ex->trust_cache && target->state >= PATH_DIRECTORY) || journal_replay(ex, target, key)))
+    {
+        journal_record(ex, key, true);
+        report_make(ex, folder, 0, 0);
+        return;
+    }
+    if (queue || ex->threads > 1 || ex->ring.fd >= 0)
+    {
+        batch_add(&ex->batch, target, key);
+        return;
+    }
+    size_t first_created = 0;
+    int created = make_path(ex, target, &first_created);
+    if (created >= 0)
+    {
+        cache_mark_exists(target);
+        journal_record(ex, key, true);
+    }
+    report_make(ex, folder, created, first_created);
+}
+
+
+// Execute a make statement with expansions: make each expanded path in turn
+// The paths are generated one at a time, like an odometer whose last part turns
+// fastest, and only the directory names after the part that changed are rebuilt
+void expand(const Instruction* ins, Executor* ex)
+{
+    const Program* program = ex->program;
+    const PathPart* parts = program->parts + ins->path.first;
+    uint32_t count = ins->path.count;
+    // Position of each part among its values; node above each part's directory name
+    uint64_t* at = calloc(count, sizeof(uint64_t));
+    PathNode** above = malloc((count + 1) * sizeof(PathNode*));
+    if (at == NULL || above == NULL)
+    {
+        printf("Error. Out of memory while expanding a make statement.\nExiting...\n");
+        exit(1);
+    }
+    above[0] = ex->cwd;
+    for (uint32_t i = 0; i < ins->path.parents; i++)
+    {
+        above[0] = above[0]->parent;
+    }
+
+    uint32_t changed = 0;
+    while (true)
+    {
+        // Rebuild the names from the one holding the changed part
+        uint32_t start = changed;
+        while (start > 0 && parts[start].joined)
+        {
+            start--;
+        }
+        while (start < count)
+        {
+            char name[NAME_MAX + 1];
+            size_t len;
+            uint32_t end = build_name(ex, parts, count, at, start, name, &len);
+            if (len >= sizeof(name))
+            {
+                say(ex, "Error. An expanded directory name is longer than %d characters.\n", NAME_MAX);
+                COUNT(failed_makes, 1);
+                free(at);
+                free(above);
+                return;
+            }
+            above[end] = path_child(above[start], intern(name, len));
+            start = end;
+        }
+        make_target(ex, above[count], false);
+        if (ex->batch.count >= EXPAND_BATCH)
+        {
+            flush_makes(ex);
+        }
+
+        // Turn the odometer; done once the first part wraps around
+        uint32_t p = count;
+        while (p > 0 && ++at[p - 1] == part_size(&parts[p - 1]))
+        {
+            at[--p] = 0;
+        }
+        if (p == 0)
+        {
+            break;
+        }
+        changed = p - 1;
+    }
+    free(at);
+    free(above);
+}
+
+
+// Build the directory name made of the parts from 'start' up to the next unjoined one,
+// each at its 'at'th value (its only value when 'at' is NULL), into 'name' (NAME_MAX + 1
+// characters); sets 'len' (NAME_MAX + 1 when cut there) and returns the next name's part
+uint32_t build_name(Executor* ex, const PathPart* parts, uint32_t count, const uint64_t* at, uint32_t start, char* name, size_t* len)
+{
+    size_t size = NAME_MAX + 1;
+    *len = 0;
+    uint32_t end = start;
+    do
+    {
+        *len += part_value(ex, &parts[end], at ? at[end] : 0, name + *len, size - *len);
+        end++;
+    }
+    while (end < count && parts[end].joined && *len < size);
+    while (end < count && parts[end].joined)
+    {
+        end++;
+    }
+    return end;
+}
+
+
+// Execute a use statement: make the subtree of a template under its path
+// The subtree was planned when the script was compiled, so each of its directories
+// costs one trie lookup here. Its leaves are queued in every mode and created in one
+// pass over the subtree, each directory relative to its parent's fd
+void use(const Instruction* ins, Executor* ex)
+{
+    const Program* program = ex->program;
+    const Template* template = &program->templates[ins->end];
+    const TemplateNode* nodes = program->template_nodes + template->first;
+    PathNode* root = resolve_path(ex, &ins->path);
+    ex->instance.count = 0;
+    for (uint32_t i = 0; i < template->count; i++)
+    {
+        PathNode* parent = nodes[i].parent == TEMPLATE_ROOT ? root : ex->instance.nodes[nodes[i].parent];
+        uint32_t name = program->names[nodes[i].name];
+        PathNode* node = path_child(parent, program->atoms ? program->atoms[name] : name);
+        push_node(&ex->instance, node);
+        if (nodes[i].leaf)
+        {
+            make_target(ex, node, true);
+        }
+    }
+    // Without threads or a ring, makes are not left queued past their statement
+    if (ex->batch.count >= EXPAND_BATCH || (ex->threads == 1 && ex->ring.fd < 0))
+    {
+        flush_makes(ex);
+    }
+}
+
+
+// Number of values of a part of an expanding path
+uint64_t part_size(const PathPart* part)
+{
+    switch (part->kind)
+    {
+        case part_choice: return part->last - part->first;
+        case part_range:  return (part->first <= part->last ? part->last - part->first : part->first - part->last) + 1ULL;
+    }
+    return 1;
+}
+
+
+// Write the 'at'th value of a part of an expanding path into 'name'; returns its length,
+// or 'size' if it does not fit (it is then cut to 'size' characters)
+size_t part_value(Executor* ex, const PathPart* part, uint64_t at, char* name, size_t size)
+{
+    const Program* program = ex->program;
+    const char* value;
+    size_t len;
+    char digits[NAME_MAX + 2];
+    if (part->kind == part_range || part->kind == part_index)
+    {
+        uint64_t number = part->kind == part_index ? ex->loop[part->first]
+                          : part->first <= part->last ? part->first + at : part->first - at;
+        int written = snprintf(digits, sizeof(digits), "%0*" PRIu64, (int)part->width, number);
+        value = digits;
+        len = written < 0 ? 0 : written < (int)sizeof(digits) ? (size_t)written : sizeof(digits) - 1;
+    }
+    else
+    {
+        uint32_t index = program->names[part->kind == part_choice ? part->first + at : part->first];
+        const Atom* atom = atom_at(program->atoms ? program->atoms[index] : index);
+        value = atom->name;
+        len = atom->len;
+    }
+    if (len >= size)
+    {
+        memcpy(name, value, size);
+        return size;
+    }
+    memcpy(name, value, len);
+    return len;
+}
+
+
+// Write a statement message to the executor's output, if it has one
+void say(Executor* ex, const char* format, ...)
+{
+    if (ex->out == NULL)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(ex->out, format, args);
+    va_end(args);
+}
+
+
+// Print the outcome of a make statement; 'created' is -1 (with errno set) on failure
+void report_make(Executor* ex, const char* folder, int created, size_t first_created)
+{
+    if (created < 0) {
+        say(ex, "Error. Path: \'%s\' could not be created: %s\n", folder, strerror(errno));
+        COUNT(failed_makes, 1);
+    } else if (created == 0) {
+        say(ex, "Path already exists. Make statement will not be executed.\n");
+        COUNT(already_exists, 1);
+    } else {
+        COUNT(directories_created, created);
+        say(ex, "Success. Path: \'%s\' created with make command (%d new, starting at \'%.*s\').\n",
+               folder, created, (int)first_created, folder);
+    }
+}
+
+
+// Create every missing directory of a path with mkdirat, relative to its parent's directory
+// Returns the number of directories created (0 if the path already existed) and sets
+// 'first_created' to the length of the path prefix naming the first of them;
+// returns -1 with errno set on failure
+int make_path(Executor* ex, PathNode* node, size_t* first_created)
+{
+    if (node->depth == 0)
+    {
+        return 0;
+    }
+
+    // Common case: the parent is open already and only the last directory is missing, or none is
+    int created = 0;
+    int parent = dir_open(ex, node->parent);
+    if (parent < 0)
+    {
+        if (errno != ENOENT)
+        {
+            return -1;
+        }
+        created = make_path(ex, node->parent, first_created);
+        if (created < 0 || (parent = dir_open(ex, node->parent)) < 0)
+        {
+            return -1;
+        }
+    }
+    const char* name = atom_name(node->atom);
+    COUNT(mkdir_calls, 1);
+    if (mkdirat(parent, name, 0777) == 0)
+    {
+        cache_mark_created(node);
+        if (created == 0)
+        {
+            *first_created = node->len;
+        }
+        return created + 1;
+    }
+    if (errno != EEXIST)
+    {
+        return -1;
+    }
+    struct stat sb;
+    COUNT(stat_calls, 1);
+    if (fstatat(parent, name, &sb, 0) == 0 && !S_ISDIR(sb.st_mode))
+    {
+        errno = ENOTDIR;
+        return -1;
+    }
+    return created;
+}
+
+
+// Execute an if statement: true when its command should run (the path exists)
+bool ifPath_maker(const Instruction* ins, Executor* ex)
+{
+    // Queued makes may create the path this statement looks at
+    flush_makes(ex);
+    PathNode* target = resolve_path(ex, &ins->path);
+    const char* folder = path_text(ex, target);
+    if (statement_exists(ex, target, folder)) {
+        say(ex, "Path exists. If statement will be executed.\n");
+        journal_enter(ex, ins);
+        return true;
+    } else {
+        say(ex, "Path: %s does not exist. Command following if clause will not be executed.\n", folder);
+        return false;
+    }
+}
+
+
+// Execute an ifnot statement: true when its command should run (the path does not exist)
+bool ifnot(const Instruction* ins, Executor* ex)
+{
+    // Queued makes may create the path this statement looks at
+    flush_makes(ex);
+    PathNode* target = resolve_path(ex, &ins->path);
+    const char* folder = path_text(ex, target);
+    if (statement_exists(ex, target, folder)) {
+        say(ex, "Path exists. Ifnot command will not be executed.\n");
+        return false;
+    } else {
+        say(ex, "Path: %s does not exist. Command following ifnot clause will execute.\n", folder);
+        journal_enter(ex, ins);
+        return true;
+    }
+}
+
+
+/*********************************************************************
+ * Parallel make engine: with '--threads N', consecutive make        *
+ * statements are collected into a tree of target directories and   *
+ * created by a pool of N work-stealing workers. Each directory is   *
+ * a task that becomes ready once its parent exists, so independent  *
+ * subtrees are created concurrently. The batch is flushed before    *
+ * any go/if/ifnot, since those look at what the makes created.      *
+ *********************************************************************/
+
+
+// Add a path to the batch for the next statement, queueing the directories of it
+// that are not queued yet; the path trie tells which ones already are, and which
+// parents are known to exist, so that those are not made again
+void batch_add(MakeBatch* batch, PathNode* target, uint64_t key)
+{
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity ? batch->capacity * 2 : 64;
+        batch->statements = realloc(batch->statements, batch->capacity * sizeof(BatchStatement));
+        if (batch->statements == NULL)
+        {
+            printf("Error. Out of memory while queueing make statements.\nExiting...\n");
+            exit(1);
+        }
+    }
+    int owner = batch->count;
+
+    // Queue the target and its parents from the bottom up, until reaching a queued one or
+    // one known to exist, which is queued as the base of a new subtree
+    BatchNode* below = NULL;
+    BatchNode* leaf = NULL;
+    BatchNode* above = NULL;
+    PathNode* path = target;
+    for (; above == NULL; path = path->parent)
+    {
+        if (path->batch != NULL)
+        {
+            above = path->batch;
+            break;
+        }
+        bool base = path->depth == 0 || (path != target && path->state >= PATH_DIRECTORY);
+        if (batch->nodes == batch->list_capacity)
+        {
+            batch->list_capacity = batch->list_capacity ? batch->list_capacity * 2 : 256;
+            batch->list = realloc(batch->list, batch->list_capacity * sizeof(BatchNode*));
+            if (batch->list == NULL)
+            {
+                printf("Error. Out of memory while queueing make statements.\nExiting...\n");
+                exit(1);
+            }
+        }
+        BatchNode* node = arena_alloc(&batch->arena, sizeof(BatchNode));
+        *node = (BatchNode){.path = path, .owner = owner, .fd = -1, .base = base};
+        path->batch = node;
+        batch->list[batch->nodes++] = node;
+        if (below != NULL)
+        {
+            below->parent = node;
+            below->sibling = node->child;
+            node->child = below;
+            node->children++;
+        }
+        else
+        {
+            leaf = node;
+        }
+        below = node;
+        if (base)
+        {
+            above = &batch->root;
+        }
+    }
+    if (below != NULL)
+    {
+        below->parent = above;
+        below->sibling = above->child;
+        above->child = below;
+        above->children++;
+    }
+    else
+    {
+        leaf = above;
+    }
+
+    batch->statements[owner].target = target;
+    batch->statements[owner].leaf = leaf;
+    batch->statements[owner].key = key;
+    batch->count++;
+}
+
+
+// Push a task onto the bottom of a worker's deque
+void deque_push(WorkDeque* deque, BatchNode* node)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->capacity)
+    {
+        // Reuse the slots already taken by thieves before growing
+        size_t used = deque->tail - deque->head;
+        if (deque->head > 0)
+        {
+            memmove(deque->tasks, deque->tasks + deque->head, used * sizeof(BatchNode*));
+            deque->head = 0;
+            deque->tail = used;
+        }
+        if (used * 2 >= deque->capacity)
+        {
+            deque->capacity = deque->capacity ? deque->capacity * 2 : 256;
+            deque->tasks = realloc(deque->tasks, deque->capacity * sizeof(BatchNode*));
+            if (deque->tasks == NULL)
+            {
+                printf("Error. Out of memory while scheduling make statements.\nExiting...\n");
+                exit(1);
+            }
+        }
+    }
+    deque->tasks[deque->tail++] = node;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+
+// Take a task from the bottom (owner) or the top (thief) of a deque; NULL if empty
+BatchNode* deque_take(WorkDeque* deque, bool steal)
+{
+    BatchNode* node = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail)
+    {
+        node = steal ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return node;
+}
+
+
+// Mark a directory and everything below it as failed with the given errno
+void batch_fail(BatchNode* node, int error)
+{
+    node->error = error;
+    for (BatchNode* child = node->child; child != NULL; child = child->sibling)
+    {
+        batch_fail(child, error);
+    }
+}
+
+
+// Create one directory of the batch relative to its parent's fd and queue its children
+void batch_create(WorkPool* pool, int worker, BatchNode* node)
+{
+    BatchNode* parent = node->parent;
+
+    const char* name = atom_name(node->path->atom);
+    COUNT(mkdir_calls, 1);
+    if (mkdirat(parent->fd, name, 0777) == 0)
+    {
+        node->created = true;
+    }
+    else if (errno != EEXIST)
+    {
+        node->error = errno;
+    }
+    else if (node->child == NULL)
+    {
+        struct stat sb;
+        COUNT(stat_calls, 1);
+        if (fstatat(parent->fd, name, &sb, 0) == 0 && !S_ISDIR(sb.st_mode))
+        {
+            node->error = ENOTDIR;
+        }
+    }
+
+    if (node->child != NULL)
+    {
+        if (node->error == 0)
+        {
+            COUNT(open_calls, 1);
+            node->fd = openat(parent->fd, name, O_PATH | O_DIRECTORY | O_CLOEXEC);
+            if (node->fd < 0)
+            {
+                node->error = errno;
+            }
+        }
+        if (node->error != 0)
+        {
+            batch_fail(node, node->error);
+        }
+        else
+        {
+            atomic_store(&node->pending, node->children);
+            atomic_fetch_add(&pool->outstanding, node->children);
+            atomic_fetch_add(&pool->queued, node->children);
+            for (BatchNode* child = node->child; child != NULL; child = child->sibling)
+            {
+                deque_push(&pool->deques[worker], child);
+            }
+            pool_wake(pool);
+        }
+    }
+
+    // The last child to finish closes its parent's directory fd
+    if (atomic_fetch_sub(&parent->pending, 1) == 1)
+    {
+        close(parent->fd);
+        parent->fd = -1;
+    }
+}
+
+
+// Worker loop: run own tasks newest first, steal the oldest tasks of others when idle,
+// and sleep while there is nothing to take but tasks are still running (a deep chain
+// only ever has one task at a time)
+void* batch_worker(void* arg)
+{
+    WorkerArg* self = arg;
+    WorkPool* pool = self->pool;
+    int worker = self->index;
+
+    while (atomic_load(&pool->outstanding) > 0)
+    {
+        BatchNode* node = deque_take(&pool->deques[worker], false);
+        for (int i = 1; node == NULL && i < pool->workers; i++)
+        {
+            node = deque_take(&pool->deques[(worker + i) % pool->workers], true);
+        }
+        if (node == NULL)
+        {
+            // 'sleeping' is raised before 'queued' is read, and raised 'queued' is read by
+            // pool_wake() before 'sleeping' is: one of the two always sees the other
+            pthread_mutex_lock(&pool->idle_lock);
+            atomic_fetch_add(&pool->sleeping, 1);
+            while (atomic_load(&pool->queued) == 0 && atomic_load(&pool->outstanding) > 0)
+            {
+                pthread_cond_wait(&pool->ready, &pool->idle_lock);
+            }
+            atomic_fetch_sub(&pool->sleeping, 1);
+            pthread_mutex_unlock(&pool->idle_lock);
+            continue;
+        }
+        atomic_fetch_sub(&pool->queued, 1);
+        batch_create(pool, worker, node);
+        if (atomic_fetch_sub(&pool->outstanding, 1) == 1)
+        {
+            // The last task is done: let the sleeping workers return
+            pool_wake(pool);
+        }
+    }
+    return NULL;
+}
+
+
+// Wake the workers sleeping in batch_worker(), after tasks were queued or the last one finished
+void pool_wake(WorkPool* pool)
+{
+    if (atomic_load(&pool->sleeping) > 0)
+    {
+        pthread_mutex_lock(&pool->idle_lock);
+        pthread_cond_broadcast(&pool->ready);
+        pthread_mutex_unlock(&pool->idle_lock);
+    }
+}
+
+
+// Create the directories below the bases 'first' up to 'last' with a pool of work-stealing
+// threads; the bases were opened by batch_open_bases(), and the directories below them are
+// the tasks
+void create_batch_threads(MakeBatch* batch, BatchNode* first, BatchNode* last, int threads)
+{
+    int tasks = 0;
+    for (BatchNode* base = first; base != last; base = base->sibling)
+    {
+        if (base->fd >= 0)
+        {
+            tasks += base->children;
+        }
+    }
+    if (tasks > 0)
+    {
+        // Small batches are not worth waking up any threads for
+        int workers = threads;
+        if (batch->nodes < PARALLEL_MIN_DIRECTORIES)
+        {
+            workers = 1;
+        }
+
+        WorkPool pool;
+        pool.workers = workers;
+        atomic_store(&pool.sleeping, 0);
+        pthread_mutex_init(&pool.idle_lock, NULL);
+        pthread_cond_init(&pool.ready, NULL);
+        pool.deques = calloc(workers, sizeof(WorkDeque));
+        WorkerArg* args = calloc(workers, sizeof(WorkerArg));
+        pthread_t* threads = calloc(workers, sizeof(pthread_t));
+        if (pool.deques == NULL || args == NULL || threads == NULL)
+        {
+            printf("Error. Out of memory while scheduling make statements.\nExiting...\n");
+            exit(1);
+        }
+        for (int i = 0; i < workers; i++)
+        {
+            pthread_mutex_init(&pool.deques[i].lock, NULL);
+            args[i].pool = &pool;
+            args[i].index = i;
+        }
+        atomic_store(&pool.outstanding, tasks);
+        atomic_store(&pool.queued, tasks);
+        for (BatchNode* base = first; base != last; base = base->sibling)
+        {
+            if (base->fd < 0)
+            {
+                continue;
+            }
+            atomic_store(&base->pending, base->children);
+            for (BatchNode* child = base->child; child != NULL; child = child->sibling)
+            {
+                deque_push(&pool.deques[0], child);
+            }
+        }
+
+        // The calling thread works as worker 0; a worker that cannot start just leaves its share to the others
+        for (int i = 1; i < workers; i++)
+        {
+            if (pthread_create(&threads[i], NULL, batch_worker, &args[i]) != 0)
+            {
+                threads[i] = 0;
+            }
+        }
+        batch_worker(&args[0]);
+        for (int i = 1; i < workers; i++)
+        {
+            if (threads[i] != 0)
+            {
+                pthread_join(threads[i], NULL);
+            }
+        }
+
+        for (int i = 0; i < workers; i++)
+        {
+            pthread_mutex_destroy(&pool.deques[i].lock);
+            free(pool.deques[i].tasks);
+        }
+        pthread_mutex_destroy(&pool.idle_lock);
+        pthread_cond_destroy(&pool.ready);
+        free(pool.deques);
+        free(args);
+        free(threads);
+    }
+}
+
+
+// Open the bases of a batch's subtrees from 'first' on through the directory cache, which
+// needs only search permission on the directories above them. A base removed since it was
+// seen is made again first, as make_path() would; one that was found is only kept open
+// while its children are created, and at most open_budget are kept open.
+// Returns the first base not opened, NULL once every one was
+BatchNode* batch_open_bases(Executor* ex, BatchNode* first)
+{
+    size_t kept = 0;
+    BatchNode* base = first;
+    for (; base != NULL && kept < open_budget; base = base->sibling)
+    {
+        int fd = dir_open(ex, base->path);
+        if (fd < 0 && errno == ENOENT)
+        {
+            size_t first_created;
+            int created = make_path(ex, base->path, &first_created);
+            base->created = created > 0;
+            fd = created < 0 ? -1 : dir_open(ex, base->path);
+        }
+        // The cache may close its descriptor at the next open, so the batch takes a copy
+        if (fd >= 0 && base->child != NULL)
+        {
+            fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        }
+        if (fd < 0)
+        {
+            batch_fail(base, errno);
+        }
+        else if (base->child != NULL)
+        {
+            base->fd = fd;
+            kept++;
+        }
+    }
+    return base;
+}
+
+
+// Create every queued directory, report each make statement in order and empty the batch
+// Returns the number of make statements that failed
+int flush_makes(Executor* ex)
+{
+    MakeBatch* batch = &ex->batch;
+    if (batch->count == 0)
+    {
+        return 0;
+    }
+
+    // The subtrees are created a round of bases at a time, so that the fds kept open stay
+    // within open_budget however many bases the batch has
+    pthread_once(&budget_once, choose_open_budget);
+    BatchNode* root = &batch->root;
+    for (BatchNode* next = root->child; next != NULL;)
+    {
+        BatchNode* first = next;
+        next = batch_open_bases(ex, first);
+        bool done = false;
+        if (ex->ring.fd >= 0)
+        {
+            done = uring_create_batch(&ex->ring, batch, first, next);
+            if (!done)
+            {
+                // The ring stopped working part way: stop using it and let the threads redo the round
+                uring_close(&ex->ring);
+                for (BatchNode* base = first; base != next; base = base->sibling)
+                {
+                    batch_reset(base);
+                }
+                next = batch_open_bases(ex, first);
+            }
+        }
+        if (!done)
+        {
+            create_batch_threads(batch, first, next, ex->threads);
+        }
+    }
+
+    // Report in statement order; a directory counts for the first statement that needed it
+    int failed = 0;
+    for (int i = 0; i < batch->count; i++)
+    {
+        BatchStatement* statement = &batch->statements[i];
+        int created = 0;
+        size_t first_created = 0;
+        const char* folder = path_text(ex, statement->target);
+        if (statement->leaf->error == 0)
+        {
+            cache_mark_exists(statement->target);
+            journal_record(ex, statement->key, true);
+        }
+        else
+        {
+            failed++;
+        }
+        for (BatchNode* node = statement->leaf; node != root; node = node->parent)
+        {
+            if (node->owner == i && node->created)
+            {
+                cache_mark_created(node->path);
+                created++;
+                first_created = node->path->len;
+            }
+        }
+        errno = statement->leaf->error;
+        report_make(ex, folder, statement->leaf->error ? -1 : created, first_created);
+    }
+
+    clear_batch(batch);
+    return failed;
+}
+
+
+// Forget how far a subtree of the batch got, closing its open fds, so that it can be created
+// again. The directories already made stay marked as created: making them again only finds them
+void batch_reset(BatchNode* node)
+{
+    if (node->fd >= 0)
+    {
+        close(node->fd);
+    }
+    node->fd = -1;
+    node->error = 0;
+    atomic_store(&node->pending, 0);
+    for (BatchNode* child = node->child; child != NULL; child = child->sibling)
+    {
+        batch_reset(child);
+    }
+}
+
+
+// Choose open_budget from the soft limit on open files (called once, through budget_once)
+void choose_open_budget(void)
+{
+    struct rlimit limit;
+    rlim_t files = getrlimit(RLIMIT_NOFILE, &limit) == 0 ? limit.rlim_cur : 1024;
+    if (files == RLIM_INFINITY || files / 4 > OPEN_BUDGET_MAX)
+    {
+        open_budget = OPEN_BUDGET_MAX;
+    }
+    else
+    {
+        open_budget = files / 4 > 0 ? files / 4 : 1;
+    }
+}
+
+
+// Empty a batch once it was created; its memory is kept for the next one
+void clear_batch(MakeBatch* batch)
+{
+    for (size_t i = 0; i < batch->nodes; i++)
+    {
+        batch->list[i]->path->batch = NULL;
+    }
+    batch->nodes = 0;
+    batch->count = 0;
+    batch->root = (BatchNode){.fd = -1};
+    arena_reset(&batch->arena);
+}
+
+
+// Release all the memory of a batch, when its executor is done
+void free_batch(MakeBatch* batch)
+{
+    clear_batch(batch);
+    free(batch->list);
+    free(batch->statements);
+    arena_free(&batch->arena);
+    memset(batch, 0, sizeof(MakeBatch));
+    batch->root.fd = -1;
+}
+
+
+/*********************************************************************
+ * Planner: with '--plan FILE' the script runs against a simulated   *
+ * filesystem instead of the real one. Each real directory the       *
+ * script looks into is read once, and make statements only mark     *
+ * directories as existing in the path trie. The directories that    *
+ * would have been created are written to FILE as a minimal list of  *
+ * make statements, relative to the starting directory: nothing that *
+ * exists, nothing twice, and no path that a deeper one implies.     *
+ *                                                                   *
+ * '--reconcile report|apply' runs the same simulation and then      *
+ * compares the directories the script wants (its make targets and   *
+ * the directories above them) with those on disk. Only directories  *
+ * on the way to a target are read, so subtrees the script never     *
+ * touches are pruned. Missing and extra directories are listed,     *
+ * matching ones counted, and 'apply' creates the missing ones.      *
+ *********************************************************************/
+
+
+// Read a real directory once and record each of its subdirectories as existing
+void scan_directory(Executor* ex, PathNode* node)
+{
+    node->scanned = true;
+    int parent = node->depth > 0 ? dir_open(ex, node->parent) : AT_FDCWD;
+    if (parent < 0)
+    {
+        return;
+    }
+    COUNT(open_calls, 1);
+    int fd = openat(parent, node->depth > 0 ? atom_name(node->atom) : "/", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+#ifdef __linux__
+    // One getdents64 call returns a whole buffer of entries
+    char buffer[DIRENT_BUFFER] __attribute__((aligned(8)));
+    long bytes;
+    while ((bytes = syscall(SYS_getdents64, fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (long offset = 0; offset < bytes;)
+        {
+            struct dirent64* entry = (struct dirent64*)(buffer + offset);
+            scan_entry(ex, node, fd, entry->d_name, entry->d_type);
+            offset += entry->d_reclen;
+        }
+    }
+    close(fd);
+#else
+    DIR* dir = fdopendir(fd);
+    if (dir == NULL)
+    {
+        close(fd);
+        return;
+    }
+    for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir))
+    {
+        scan_entry(ex, node, dirfd(dir), entry->d_name, entry->d_type);
+    }
+    closedir(dir);
+#endif
+}
+
+
+// Record one entry of a directory being read, if it is a subdirectory
+void scan_entry(Executor* ex, PathNode* node, int fd, const char* name, unsigned char type)
+{
+    if (!strcmp(name, ".") || !strcmp(name, ".."))
+    {
+        return;
+    }
+    bool is_dir = type == DT_DIR;
+    if (type == DT_UNKNOWN || type == DT_LNK)
+    {
+        struct stat sb;
+        COUNT(stat_calls, 1);
+        is_dir = fstatat(fd, name, &sb, 0) == 0 && S_ISDIR(sb.st_mode);
+    }
+    if (is_dir)
+    {
+        PathNode* child = path_child(node, intern(name, strlen(name)));
+        child->state = PATH_DIRECTORY;
+        if (ex->reconciling)
+        {
+            push_node(&ex->found, child);
+        }
+    }
+}
+
+
+// Check whether a path exists in the simulated filesystem, reading its parent if needed
+bool plan_exists(Executor* ex, PathNode* node)
+{
+    if (node->state != PATH_UNKNOWN)
+    {
+        return node->state >= PATH_DIRECTORY;
+    }
+    PathNode* parent = node->parent;
+    if (plan_exists(ex, parent) && !parent->scanned)
+    {
+        scan_directory(ex, parent);
+    }
+    if (node->state == PATH_UNKNOWN)
+    {
+        node->state = PATH_MISSING;
+    }
+    return node->state >= PATH_DIRECTORY;
+}
+
+
+// Simulate a make statement and add its target to the plan
+void plan_make(Executor* ex, PathNode* target, const char* folder)
+{
+    if (ex->reconciling)
+    {
+        push_node(&ex->targets, target);
+    }
+    if (plan_exists(ex, target))
+    {
+        report_make(ex, folder, 0, 0);
+        return;
+    }
+
+    // The missing part of the path ends at its deepest existing directory; if that
+    // directory is an earlier planned target, this deeper one now implies it
+    int created = 0;
+    PathNode* first = target;
+    PathNode* node = target;
+    for (; node->state < PATH_DIRECTORY; node = node->parent)
+    {
+        node->state = PATH_DIRECTORY;
+        node->simulated = true;
+        first = node;
+        created++;
+    }
+    if (node->planned)
+    {
+        node->covered = true;
+    }
+    target->planned = true;
+    ex->planned_directories += created;
+    push_node(&ex->plan, target);
+    report_make(ex, folder, created, first->len);
+}
+
+
+// Append a path node to a list
+void push_node(NodeList* list, PathNode* node)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->nodes = realloc(list->nodes, list->capacity * sizeof(PathNode*));
+        if (list->nodes == NULL)
+        {
+            printf("Error. Out of memory while storing paths.\nExiting...\n");
+            exit(1);
+        }
+    }
+    list->nodes[list->count++] = node;
+}
+
+
+// Write a path relative to another one as a path_maker path expression
+void write_relative_path(FILE* fptr, PathNode* from, PathNode* to)
+{
+    // Climb to the deepest common directory, counting the '*' needed from 'from'
+    PathNode* a = from;
+    PathNode* b = to;
+    while (a->depth > b->depth)
+    {
+        a = a->parent;
+    }
+    while (b->depth > a->depth)
+    {
+        b = b->parent;
+    }
+    while (a != b)
+    {
+        a = a->parent;
+        b = b->parent;
+    }
+
+    fputc('<', fptr);
+    bool first = true;
+    for (uint32_t i = a->depth; i < from->depth; i++)
+    {
+        fputs(first ? "*" : "/*", fptr);
+        first = false;
+    }
+
+    // Names from the common directory down to 'to', written top-down
+    uint32_t count = to->depth - a->depth;
+    PathNode** names = malloc((count ? count : 1) * sizeof(PathNode*));
+    if (names == NULL)
+    {
+        printf("Error. Out of memory while writing the plan.\nExiting...\n");
+        exit(1);
+    }
+    PathNode* node = to;
+    for (uint32_t i = count; i > 0; i--, node = node->parent)
+    {
+        names[i - 1] = node;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!first)
+        {
+            fputc('/', fptr);
+        }
+        fputs(atom_name(names[i]->atom), fptr);
+        first = false;
+    }
+    free(names);
+    fputc('>', fptr);
+}
+
+
+// Write the plan as make statements relative to the starting directory
+bool write_plan(Executor* ex, PathNode* start, const char* filename)
+{
+    FILE* fptr = fopen(filename, "w");
+    if (fptr == NULL)
+    {
+        return false;
+    }
+    int statements = 0;
+    for (size_t i = 0; i < ex->plan.count; i++)
+    {
+        if (!ex->plan.nodes[i]->covered)
+        {
+            fputs("make ", fptr);
+            write_relative_path(fptr, start, ex->plan.nodes[i]);
+            fputs(";\n", fptr);
+            statements++;
+        }
+    }
+    if (fclose(fptr) != 0)
+    {
+        return false;
+    }
+    printf("Plan: %zu directories to create with %d make statements, written to %s\n",
+           ex->planned_directories, statements, filename);
+    return true;
+}
+
+
+// Check whether a path is a directory or subdirectory of another one
+bool path_under(const PathNode* node, const PathNode* root)
+{
+    while (node->depth > root->depth)
+    {
+        node = node->parent;
+    }
+    return node == root;
+}
+
+
+// Mark a wanted directory and those above it up to the starting directory, listing each
+// once in top-down order; outside the starting directory only missing ones are wanted
+void reconcile_mark(NodeList* wanted, PathNode* root, PathNode* node, bool under, uint8_t mark)
+{
+    bool listed = node->wanted != 0;
+    node->wanted |= mark;
+    if (listed || node == root)
+    {
+        return;
+    }
+    PathNode* parent = node->parent;
+    if (parent != node && (under || parent->simulated))
+    {
+        reconcile_mark(wanted, root, parent, under, WANTED_ABOVE);
+    }
+    push_node(wanted, node);
+}
+
+
+// Compare the wanted directories with the real ones and report the differences;
+// with 'apply', create the missing directories
+bool reconcile(Executor* ex, PathNode* root, bool apply)
+{
+    NodeList wanted = {NULL, 0, 0};
+    for (size_t i = 0; i < ex->targets.count; i++)
+    {
+        PathNode* target = ex->targets.nodes[i];
+        reconcile_mark(&wanted, root, target, path_under(target, root), WANTED_TARGET);
+    }
+
+    // A wanted directory that exists was read from its parent during the simulation;
+    // one that was created there is missing
+    size_t matching = 0;
+    size_t missing = 0;
+    size_t extra = 0;
+    for (size_t i = 0; i < wanted.count; i++)
+    {
+        if (wanted.nodes[i]->simulated)
+        {
+            printf("Missing: %s\n", path_text(ex, wanted.nodes[i]));
+            missing++;
+        }
+        else
+        {
+            matching++;
+        }
+    }
+    // Real directories read from a wanted one that contains targets, but not wanted themselves
+    for (size_t i = 0; i < ex->found.count; i++)
+    {
+        PathNode* node = ex->found.nodes[i];
+        if (node->wanted == 0 && (node->parent->wanted & WANTED_ABOVE))
+        {
+            printf("Extra: %s\n", path_text(ex, node));
+            extra++;
+        }
+    }
+    printf("Reconcile: %zu matching, %zu missing, %zu extra directories.\n", matching, missing, extra);
+    free(wanted.nodes);
+    if (!apply || missing == 0)
+    {
+        return true;
+    }
+
+    // Create the missing directories with the minimal list of make targets; the failures
+    // are counted here, since '--stats' counts those of every phase and script
+    ex->planning = false;
+    ex->out = stdout;
+    int failed = 0;
+    for (size_t i = 0; i < ex->plan.count; i++)
+    {
+        PathNode* target = ex->plan.nodes[i];
+        if (target->covered)
+        {
+            continue;
+        }
+        if (ex->threads > 1 || ex->ring.fd >= 0)
+        {
+            batch_add(&ex->batch, target, 0);
+            continue;
+        }
+        size_t first_created = 0;
+        int created = make_path(ex, target, &first_created);
+        if (created < 0)
+        {
+            failed++;
+        }
+        report_make(ex, path_text(ex, target), created, first_created);
+    }
+    failed += flush_makes(ex);
+    return failed == 0;
+}
+
+
+/*********************************************************************
+ * io_uring backend: with '--io-uring', queued make statements are   *
+ * created with batched IORING_OP_MKDIRAT, IORING_OP_OPENAT and      *
+ * IORING_OP_STATX submissions instead of one blocking system call   *
+ * at a time. The directories are created one depth level per       *
+ * submission, each relative to its parent's fd like the thread      *
+ * engine does, so every parent exists before its children are       *
+ * submitted and the kernel only looks up one name per operation.    *
+ * When the kernel lacks io_uring or these operations, the           *
+ * synchronous engine is used instead.                               *
+ *********************************************************************/
+
+#ifdef __linux__
+
+// Open the ring and check that the kernel supports the operations used
+bool uring_open(Uring* ring)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(Uring));
+    ring->fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if (ring->fd < 0)
+    {
+        ring->fd = -1;
+        return false;
+    }
+
+    // The probe lists the opcodes this kernel knows about (MKDIRAT needs 5.15)
+    size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = calloc(1, probe_size);
+    bool supported = probe != NULL
+        && syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256) == 0
+        && probe->last_op >= IORING_OP_MKDIRAT
+        && (probe->ops[IORING_OP_MKDIRAT].flags & IO_URING_OP_SUPPORTED)
+        && (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED)
+        && (probe->ops[IORING_OP_STATX].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    if (!supported || !(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        close(ring->fd);
+        ring->fd = -1;
+        return false;
+    }
+
+    // Submission and completion rings share one mapping; the entries have their own
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    ring->ring_ptr = mmap(NULL, ring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring->fd, IORING_OFF_SQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->ring_ptr == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        if (ring->ring_ptr != MAP_FAILED) munmap(ring->ring_ptr, ring->ring_size);
+        if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+        close(ring->fd);
+        ring->fd = -1;
+        return false;
+    }
+
+    char* base = ring->ring_ptr;
+    ring->sq_tail = (unsigned*)(base + params.sq_off.tail);
+    ring->sq_mask = *(unsigned*)(base + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(base + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = (unsigned*)(base + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(base + params.cq_off.tail);
+    ring->cq_mask = *(unsigned*)(base + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(base + params.cq_off.cqes);
+    return true;
+}
+
+
+// Unmap and close the ring
+void uring_close(Uring* ring)
+{
+    if (ring->fd < 0)
+    {
+        return;
+    }
+    munmap(ring->sqes, ring->sqes_size);
+    munmap(ring->ring_ptr, ring->ring_size);
+    close(ring->fd);
+    ring->fd = -1;
+}
+
+
+// Run a list of independent operations, at most one ring's worth per submission,
+// and store each result (0 or the opened fd, or -errno) in ops[i].result
+bool uring_run(Uring* ring, UringOp* ops, size_t count)
+{
+    for (size_t done = 0; done < count;)
+    {
+        unsigned batch = count - done < ring->sq_entries ? count - done : ring->sq_entries;
+        unsigned tail = *ring->sq_tail;
+        for (unsigned i = 0; i < batch; i++)
+        {
+            UringOp* op = &ops[done + i];
+            unsigned index = (tail + i) & ring->sq_mask;
+            struct io_uring_sqe* sqe = &ring->sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->fd = op->dirfd;
+            sqe->addr = (uintptr_t)op->path;
+            if (op->kind == uop_statx)
+            {
+                COUNT(stat_calls, 1);
+                sqe->opcode = IORING_OP_STATX;
+                sqe->len = STATX_TYPE;
+                sqe->addr2 = (uintptr_t)&op->stx;
+            }
+            else if (op->kind == uop_open)
+            {
+                COUNT(open_calls, 1);
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->open_flags = O_PATH | O_DIRECTORY | O_CLOEXEC;
+            }
+            else
+            {
+                COUNT(mkdir_calls, 1);
+                sqe->opcode = IORING_OP_MKDIRAT;
+                sqe->len = 0777;
+            }
+            sqe->user_data = done + i;
+            ring->sq_array[index] = index;
+        }
+        atomic_store_explicit((_Atomic unsigned*)ring->sq_tail, tail + batch, memory_order_release);
+
+        unsigned completed = 0;
+        while (completed < batch)
+        {
+            if (syscall(__NR_io_uring_enter, ring->fd, completed == 0 ? batch : 0, batch - completed,
+                        IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            {
+                return false;
+            }
+            unsigned head = *ring->cq_head;
+            unsigned cq_tail = atomic_load_explicit((_Atomic unsigned*)ring->cq_tail, memory_order_acquire);
+            for (; head != cq_tail; head++, completed++)
+            {
+                struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+                ops[cqe->user_data].result = cqe->res;
+            }
+            atomic_store_explicit((_Atomic unsigned*)ring->cq_head, head, memory_order_release);
+        }
+        done += batch;
+    }
+    return true;
+}
+
+
+// Create the directories below the bases 'first' up to 'last' through the ring, a round at a
+// time: each round makes directories from the top of a stack relative to their parents' fds,
+// then opens the ones with children (O_PATH) and checks the existing leaves with statx. A
+// directory is closed once its last child was made, and a round only takes a directory with
+// children while the ones the ring holds open stay within open_budget, so that wide trees do
+// not run out of descriptors. False if the ring stopped working, in which case the caller
+// resets those subtrees and finishes them with the threads
+bool uring_create_batch(Uring* ring, MakeBatch* batch, BatchNode* first, BatchNode* last)
+{
+    // Everything here is allocated from the batch's arena, which is emptied with the batch
+    BatchNode** stack = arena_alloc(&batch->arena, batch->nodes * sizeof(BatchNode*));
+    BatchNode** round = arena_alloc(&batch->arena, open_budget * sizeof(BatchNode*));
+    BatchNode** opened = arena_alloc(&batch->arena, open_budget * sizeof(BatchNode*));
+    UringOp* ops = arena_alloc(&batch->arena, open_budget * sizeof(UringOp));
+    size_t top = 0;
+    for (BatchNode* base = first; base != last; base = base->sibling)
+    {
+        if (base->fd >= 0)
+        {
+            atomic_store(&base->pending, base->children);
+            for (BatchNode* child = base->child; child != NULL; child = child->sibling)
+            {
+                stack[top++] = child;
+            }
+        }
+    }
+
+    // Directories opened by the ring and not closed yet; the bases are not counted
+    size_t open = 0;
+    while (top > 0)
+    {
+        // A round always takes at least one directory, so that it makes progress
+        size_t n = 0;
+        size_t opening = 0;
+        while (top > 0 && n < open_budget)
+        {
+            BatchNode* node = stack[top - 1];
+            if (node->child != NULL && n > 0 && open + opening >= open_budget)
+            {
+                break;
+            }
+            top--;
+            opening += node->child != NULL;
+            ops[n] = (UringOp){node->parent->fd, atom_name(node->path->atom), uop_mkdir, -ECANCELED, {0}};
+            round[n++] = node;
+        }
+        if (!uring_run(ring, ops, n))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            if (ops[i].result == 0)
+            {
+                round[i]->created = true;
+            }
+            else if (ops[i].result != -EEXIST)
+            {
+                round[i]->error = -ops[i].result;
+            }
+        }
+
+        // Open the directories with children, which also checks that they are directories;
+        // an existing leaf is checked with statx
+        size_t m = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (round[i]->error != 0 || (round[i]->child == NULL && ops[i].result != -EEXIST))
+            {
+                continue;
+            }
+            ops[m] = (UringOp){ops[i].dirfd, ops[i].path, round[i]->child != NULL ? uop_open : uop_statx,
+                               -ECANCELED, {0}};
+            opened[m++] = round[i];
+        }
+        bool ok = uring_run(ring, ops, m);
+        for (size_t i = 0; i < m; i++)
+        {
+            if (!ok)
+            {
+                // Keep the fds that were opened, so that the caller's reset closes them
+                if (ops[i].kind == uop_open && ops[i].result >= 0)
+                {
+                    opened[i]->fd = ops[i].result;
+                }
+            }
+            else if (ops[i].kind == uop_open)
+            {
+                if (ops[i].result >= 0)
+                {
+                    opened[i]->fd = ops[i].result;
+                }
+                else
+                {
+                    opened[i]->error = -ops[i].result;
+                }
+            }
+            else if (ops[i].result != 0 || !S_ISDIR(ops[i].stx.stx_mode))
+            {
+                opened[i]->error = ops[i].result != 0 ? -ops[i].result : ENOTDIR;
+            }
+        }
+        if (!ok)
+        {
+            return false;
+        }
+
+        // The children of the opened directories come next; children of a failed one fail too
+        for (size_t i = 0; i < n; i++)
+        {
+            BatchNode* node = round[i];
+            if (node->fd >= 0)
+            {
+                open++;
+                atomic_store(&node->pending, node->children);
+                for (BatchNode* child = node->child; child != NULL; child = child->sibling)
+                {
+                    stack[top++] = child;
+                }
+            }
+            else if (node->child != NULL)
+            {
+                batch_fail(node, node->error);
+            }
+            BatchNode* parent = node->parent;
+            if (atomic_fetch_sub(&parent->pending, 1) == 1)
+            {
+                close(parent->fd);
+                parent->fd = -1;
+                open -= !parent->base;
+            }
+        }
+    }
+    return true;
+}
+
+#else
+
+bool uring_open(Uring* ring)
+{
+    ring->fd = -1;
+    return false;
+}
+
+void uring_close(Uring* ring)
+{
+    (void)ring;
+}
+
+bool uring_create_batch(Uring* ring, MakeBatch* batch, BatchNode* first, BatchNode* last)
+{
+    (void)ring;
+    (void)batch;
+    (void)first;
+    (void)last;
+    return false;
+}
+
+#endif
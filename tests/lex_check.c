@@ -0,0 +1,220 @@
+/*********************************************************************************************************************************************************
+Lexer check for the 'Path_maker' interpreter.
+
+    Lexes each script named on the command line, and a generated script of a few megabytes, in one pass with the scalar byte classifier, then
+    again with every classifier the processor supports and split into 2 to 8 parts lexed in parallel, and compares the tokens. An invalid script
+    must fail every time, with the same message.
+
+    Run by tests/run_tests.sh; exits with 1 if any way of lexing differs from the first.
+
+    Build: gcc -O2 -pthread tests/lex_check.c -o lex_check
+***************************************************************************************************************************************************************/
+
+
+#define PATH_MAKER_NO_MAIN
+#include "../main.c"
+
+
+// Result of lexing a source one way: the tokens, or the error message
+typedef struct
+{
+    bool ok;
+    TokenStream tokens;
+    char* message;
+    size_t message_size;
+} LexResult;
+
+
+// Function prototypes
+void lex_one_way(const char* text, size_t size, int parts, LexResult* result);
+bool same_result(const LexResult* a, const LexResult* b, const char* name, const char* way);
+void free_result(LexResult* result);
+bool check_source(const char* text, size_t size, const char* name);
+char* generate_source(size_t* size);
+
+
+// Byte classifiers to compare, the first being the reference
+ByteClasses (*classifiers[3])(const char* text, size_t n);
+const char* classifier_names[3];
+int classifier_count;
+
+
+// Lexer check program logic
+int main(int argc, char* argv[])
+{
+    pthread_once(&classify_once, choose_classifier);
+    classifiers[classifier_count] = classify_scalar;
+    classifier_names[classifier_count++] = "scalar";
+#if defined(__x86_64__) && defined(__GNUC__)
+    classifiers[classifier_count] = classify_sse2;
+    classifier_names[classifier_count++] = "sse2";
+    if (__builtin_cpu_supports("avx2"))
+    {
+        classifiers[classifier_count] = classify_avx2;
+        classifier_names[classifier_count++] = "avx2";
+    }
+#endif
+
+    bool ok = true;
+    for (int i = 1; i < argc; i++)
+    {
+        Source source;
+        if (!source_open(argv[i], &source))
+        {
+            printf("Error. Could not read %s.\n", argv[i]);
+            return 1;
+        }
+        ok = check_source(source.data, source.size, argv[i]) && ok;
+        source_close(&source);
+    }
+
+    size_t size;
+    char* generated = generate_source(&size);
+    ok = check_source(generated, size, "generated script") && ok;
+
+    // The same script with an invalid name near its end, so that a later part fails
+    memcpy(generated + size - size / 7, "make <bad-name>;", 16);
+    ok = check_source(generated, size, "generated script with an error") && ok;
+    free(generated);
+    return ok ? 0 : 1;
+}
+
+
+// Lex a source with the current classifier, in one pass (parts 1) or in that many parallel parts
+void lex_one_way(const char* text, size_t size, int parts, LexResult* result)
+{
+    result->tokens = (TokenStream){.type = t_None, .source = text};
+    result->message = NULL;
+    result->message_size = 0;
+    diagnostics = open_memstream(&result->message, &result->message_size);
+    if (diagnostics == NULL)
+    {
+        printf("Error. Out of memory.\n");
+        exit(1);
+    }
+    result->ok = parts > 1 ? lex_parallel(text, size, &result->tokens, parts)
+                           : lex_span(text, 0, size, &result->tokens, NULL);
+    fclose(diagnostics);
+    diagnostics = NULL;
+}
+
+
+// Compare a result with the reference; prints the first difference
+bool same_result(const LexResult* a, const LexResult* b, const char* name, const char* way)
+{
+    if (a->ok != b->ok || strcmp(a->message, b->message))
+    {
+        printf("%s, %s: lexing %s (\"%s\" instead of \"%s\")\n", name, way,
+               b->ok ? "succeeded" : "failed", b->message, a->message);
+        return false;
+    }
+    if (!a->ok)
+    {
+        return true;
+    }
+    if (a->tokens.count != b->tokens.count)
+    {
+        printf("%s, %s: %zu tokens instead of %zu\n", name, way, b->tokens.count, a->tokens.count);
+        return false;
+    }
+    for (size_t i = 0; i < a->tokens.count; i++)
+    {
+        const Token* x = &a->tokens.tokens[i];
+        const Token* y = &b->tokens.tokens[i];
+        if (x->type != y->type || x->atom != y->atom || x->offset != y->offset || x->length != y->length)
+        {
+            printf("%s, %s: token %zu is %s at %u (length %u, atom %u) instead of %s at %u (length %u, atom %u)\n",
+                   name, way, i, tokenNames[y->type], y->offset, y->length, y->atom,
+                   tokenNames[x->type], x->offset, x->length, x->atom);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Release a result
+void free_result(LexResult* result)
+{
+    free_tokens(&result->tokens);
+    free(result->message);
+}
+
+
+// Lex a source every way and compare each with one scalar pass
+bool check_source(const char* text, size_t size, const char* name)
+{
+    LexResult reference;
+    classify_bytes = classify_scalar;
+    lex_one_way(text, size, 1, &reference);
+
+    bool ok = true;
+    for (int c = 0; c < classifier_count; c++)
+    {
+        classify_bytes = classifiers[c];
+        for (int parts = 1; parts <= 8; parts++)
+        {
+            char way[64];
+            snprintf(way, sizeof(way), "%s classifier, %d part%s", classifier_names[c], parts, parts > 1 ? "s" : "");
+            LexResult result;
+            lex_one_way(text, size, parts, &result);
+            ok = same_result(&reference, &result, name, way) && ok;
+            free_result(&result);
+        }
+    }
+    free_result(&reference);
+    return ok;
+}
+
+
+// A few megabytes of every kind of token, with names of mixed case, blanks of every kind
+// and identifiers that cross the classifiers' 32-byte blocks
+char* generate_source(size_t* size)
+{
+    char* source = NULL;
+    FILE* fptr = open_memstream(&source, size);
+    if (fptr == NULL)
+    {
+        printf("Error. Out of memory.\n");
+        exit(1);
+    }
+    uint32_t seed = 12345;
+    for (int i = 0; i < 40000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        switch (seed >> 16 & 7)
+        {
+            case 0:
+                fprintf(fptr, "make <Dir%u/Sub_%d/%s>;\n", seed % 97, i, "AVeryLongDirectoryNameThatCrossesABlock");
+                break;
+            case 1:
+                fprintf(fptr, "go\t<*/*/dir%u>;\r\n", seed % 13);
+                break;
+            case 2:
+                fprintf(fptr, "if <a%u> { make <x/{b,c}/d[1..3]>; }\n", seed % 31);
+                break;
+            case 3:
+                fprintf(fptr, "ifnot<b%u>{make<C%u>;}\v\f", seed % 7, seed % 5);
+                break;
+            case 4:
+                fprintf(fptr, "repeat %u as i make <r[i]/Q>;\n", seed % 9 + 1);
+                break;
+            case 5:
+                fprintf(fptr, "define t%d { make <One/two>; }\nuse t%d at <Here%u>;\n", i, i, seed % 3);
+                break;
+            case 6:
+                fprintf(fptr, "%*s;\n", (int)(seed % 70), "");
+                break;
+            default:
+                fprintf(fptr, "make <%.*s>;\n", (int)(seed % 64) + 1,
+                        "n0123456789_abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_");
+                break;
+        }
+    }
+    if (fclose(fptr) != 0)
+    {
+        printf("Error. Out of memory.\n");
+        exit(1);
+    }
+    return source;
+}
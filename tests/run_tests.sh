@@ -0,0 +1,295 @@
+#!/bin/bash
+# Regression suite for path_maker.
+#
+#   scripts   every tests/scripts/*.pmk is run in a fresh directory, synchronously, with
+#             '--threads 4' and with '--io-uring'; what it prints and the directories it
+#             leaves must match tests/expected/NAME.out and NAME.tree in every mode
+#   compiled  every script is compiled with '--compile' and the .pmc file run instead;
+#             it must print and make the same as the source
+#   lexer     tests/lex_check.c lexes each script in one pass, in parallel parts and with
+#             every byte classifier, and compares the tokens
+#   journal   a second '--journal' run after the disk changed makes a removed directory
+#             again and follows the conditions as they are now, in every mode
+#   reconcile '--reconcile apply' succeeds when it makes every missing directory, whatever
+#             failed while the script was simulated
+#   options   combinations of options that are refused must not run anything
+#   serve     a '--serve' socket is private to its user, and a directory removed between
+#             two requests is made again by the second; a request line that is too long,
+#             or a directory longer than PATH_MAX, is refused and the next request served
+#             (sent with python3 when it is installed)
+#   access    a user who may only search a directory above the current one still makes
+#             directories below it, with one mkdir per new directory (run as 'nobody' when
+#             the suite runs as root, skipped otherwise)
+#   limits    under 'ulimit -n 64', thousands of sibling directories, and thousands of
+#             existing ones that each get a child, are all made in every mode
+#   cache     '--cache trust' stats a directory it has looked at once, '--cache verify'
+#             every time it is looked at, and both make the same directories
+#
+# Usage: tests/run_tests.sh [--update]
+# Builds path_maker and lex_check into a temporary directory (CC and CFLAGS are honoured).
+# '--update' rewrites the expected files from the current build instead of comparing.
+
+cd "$(dirname "$0")/.." || exit 1
+ROOT=$(pwd)
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2 -Wall}
+UPDATE=0
+[ "$1" = "--update" ] && UPDATE=1
+
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/path_maker_tests.XXXXXX") || exit 1
+trap 'rm -rf "$WORK"' EXIT
+PM="$WORK/path_maker"
+$CC $CFLAGS -pthread main.c -o "$PM" || exit 1
+$CC $CFLAGS -pthread tests/lex_check.c -o "$WORK/lex_check" || exit 1
+
+PASSED=0
+FAILED=0
+
+pass()
+{
+    PASSED=$((PASSED + 1))
+}
+
+fail()
+{
+    FAILED=$((FAILED + 1))
+    echo "FAIL: $*"
+}
+
+# Run path_maker with the given arguments in a fresh directory $WORK/run; the output goes to
+# $WORK/out (the directory's path replaced by ROOT) and the directories it made to $WORK/tree
+run_in_fresh()
+{
+    rm -rf "$WORK/run"
+    mkdir "$WORK/run"
+    (cd "$WORK/run" && "$PM" "$@") 2>&1 \
+        | grep -v '^io_uring is not available' \
+        | sed "s#$WORK/run#ROOT#g" > "$WORK/out"
+    (cd "$WORK/run" && find . -mindepth 1 -type d | sort) > "$WORK/tree"
+}
+
+# Compare $WORK/out and $WORK/tree with the expected files of a script
+check_run()
+{
+    local name=$1
+    local label=$2
+    if [ $UPDATE = 1 ]; then
+        cp "$WORK/out" "tests/expected/$name.out"
+        cp "$WORK/tree" "tests/expected/$name.tree"
+    fi
+    if ! diff -u "tests/expected/$name.out" "$WORK/out" > "$WORK/diff"; then
+        fail "$name ($label): output differs"
+        cat "$WORK/diff"
+    elif ! diff -u "tests/expected/$name.tree" "$WORK/tree" > "$WORK/diff"; then
+        fail "$name ($label): directories differ"
+        cat "$WORK/diff"
+    else
+        pass
+    fi
+}
+
+
+# Scripts, in each way of creating directories
+for script in tests/scripts/*.pmk; do
+    name=$(basename "$script" .pmk)
+    run_in_fresh "$ROOT/$script"
+    check_run "$name" "sync"
+    UPDATE_SAVED=$UPDATE
+    UPDATE=0
+    for mode in "--threads 4" "--io-uring"; do
+        run_in_fresh $mode "$ROOT/$script"
+        check_run "$name" "$mode"
+    done
+    UPDATE=$UPDATE_SAVED
+done
+
+
+# Compiled scripts: a .pmc file runs like its source
+for script in tests/scripts/*.pmk; do
+    name=$(basename "$script" .pmk)
+    rm -rf "$WORK/compiled"
+    mkdir "$WORK/compiled"
+    cp "$script" "$WORK/compiled/"
+    if ! (cd "$WORK/compiled" && "$PM" --compile "$name.pmk" > /dev/null); then
+        # Scripts with errors are not compiled
+        if [ -e "$WORK/compiled/$name.pmc" ]; then
+            fail "$name (compiled): a .pmc file was written for a script with errors"
+        else
+            pass
+        fi
+        continue
+    fi
+    run_in_fresh "$WORK/compiled/$name.pmc"
+    check_run "$name" "compiled"
+done
+
+
+# Lexer: one pass, parallel parts and every byte classifier give the same tokens
+if "$WORK/lex_check" tests/scripts/*.pmk > "$WORK/lex_out"; then
+    pass
+else
+    fail "lexer"
+    cat "$WORK/lex_out"
+fi
+
+
+# Journal: what the last run found is only a hint, checked against the disk
+cat > "$WORK/journal.pmk" << 'EOF'
+ifnot <flag> { make <off>; }
+if <flag> { make <on>; }
+make <made/deep>;
+repeat 2 as i make <r[i]/x>;
+EOF
+for mode in "" "--threads 4" "--io-uring"; do
+    run_in_fresh $mode --journal "$WORK/journal.pmk"
+    rmdir "$WORK/run/made/deep" "$WORK/run/off" "$WORK/run/r1/x"
+    mkdir "$WORK/run/flag"
+    (cd "$WORK/run" && "$PM" $mode --journal "$WORK/journal.pmk" > /dev/null 2>&1)
+    (cd "$WORK/run" && find . -mindepth 1 -type d | sort | tr '\n' ' ') > "$WORK/tree"
+    expected="./flag ./made ./made/deep ./on ./r0 ./r0/x ./r1 ./r1/x "
+    if [ "$(cat "$WORK/tree")" = "$expected" ]; then
+        pass
+    else
+        fail "journal (${mode:-sync}): the second run left '$(cat "$WORK/tree")' instead of '$expected'"
+    fi
+done
+
+
+# Reconcile: its result is that of its own makes, not of the simulated statements
+LONG=$(printf 'x%.0s' $(seq 300))
+printf 'make <a{%s,b}>;\nmake <ok/dir>;\n' "$LONG" > "$WORK/reconcile.pmk"
+for mode in "" "--threads 4"; do
+    rm -rf "$WORK/run"
+    mkdir "$WORK/run"
+    if (cd "$WORK/run" && "$PM" $mode --reconcile apply "$WORK/reconcile.pmk" > /dev/null 2>&1) \
+        && [ -d "$WORK/run/ok/dir" ]; then
+        pass
+    else
+        fail "reconcile (${mode:-sync}): applying the missing directories did not succeed"
+    fi
+done
+
+
+# Options: '-j' has no shared plan, reconciliation or journal for its scripts
+for option in "--journal" "--plan plan.txt" "--reconcile report"; do
+    run_in_fresh -j 2 $option "$ROOT/tests/scripts/basic.pmk" "$ROOT/tests/scripts/expand.pmk"
+    if grep -q '^Error. -j cannot be combined' "$WORK/out" && [ ! -s "$WORK/tree" ]; then
+        pass
+    else
+        fail "-j with $option was not refused"
+        cat "$WORK/out"
+    fi
+done
+
+
+# Server: the socket is made with mode 0600, and nothing is remembered between requests
+rm -rf "$WORK/run"
+mkdir "$WORK/run"
+printf 'make <served/a/b>;\n' > "$WORK/run/served.pmk"
+(cd "$WORK/run" && exec "$PM" --serve "$WORK/run/sock" > /dev/null 2>&1) &
+SERVER=$!
+for i in $(seq 50); do
+    [ -S "$WORK/run/sock" ] && break
+    sleep 0.1
+done
+if [ "$(stat -c %a "$WORK/run/sock" 2>/dev/null)" = 600 ]; then
+    pass
+else
+    fail "serve: the socket is not private to its user"
+fi
+(cd "$WORK/run" && "$PM" --connect sock served.pmk > /dev/null)
+rmdir "$WORK/run/served/a/b"
+(cd "$WORK/run" && "$PM" --connect sock served.pmk > /dev/null)
+if [ -d "$WORK/run/served/a/b" ]; then
+    pass
+else
+    fail "serve: a directory removed between requests was not made again"
+fi
+if command -v python3 > /dev/null; then
+    python3 - "$WORK/run/sock" > "$WORK/out" << 'PY'
+import socket, sys
+client = socket.socket(socket.AF_UNIX)
+client.connect(sys.argv[1])
+client.sendall(b"cwd /" + b"a" * 5000 + b"\ncwd /" + b"b" * 4100 + b"\nsource 0\n")
+client.shutdown(socket.SHUT_WR)
+while True:
+    reply = client.recv(65536)
+    if not reply:
+        break
+    sys.stdout.write(reply.decode())
+PY
+    if grep -q '^Error. Request is longer than' "$WORK/out" \
+        && grep -q '^Error. The directory of a request is longer than' "$WORK/out" \
+        && [ "$(grep -c '^done 1$' "$WORK/out")" = 2 ] && [ "$(tail -n 1 "$WORK/out")" = "done 0" ]; then
+        pass
+    else
+        fail "serve: over-long requests were not refused one by one"
+        cat "$WORK/out"
+    fi
+fi
+kill $SERVER 2>/dev/null
+wait $SERVER 2>/dev/null
+
+
+# Access: nothing above the directories that are made is opened for reading
+if [ "$(id -u)" = 0 ] && command -v setpriv > /dev/null; then
+    chmod 711 "$WORK"
+    printf 'make <q/r>;\nmake <q/s>;\ndefine app { make <src>; make <log>; }\nuse app at <t>;\n' \
+        > "$WORK/search.pmk"
+    for mode in "" "--threads 4" "--io-uring"; do
+        rm -rf "$WORK/run"
+        mkdir "$WORK/run"
+        chown nobody "$WORK/run"
+        (cd "$WORK/run" && setpriv --reuid=nobody --regid="$(id -g nobody)" --clear-groups \
+            "$PM" $mode --stats "$WORK/search.pmk" > "$WORK/out" 2>&1)
+        if [ -d "$WORK/run/q/r" ] && [ -d "$WORK/run/q/s" ] && [ -d "$WORK/run/t/src" ] \
+            && [ -d "$WORK/run/t/log" ] && grep -q '"mkdir_calls": 6,' "$WORK/out"; then
+            pass
+        else
+            fail "access (${mode:-sync}): making directories below a search-only directory"
+            cat "$WORK/out"
+        fi
+    done
+    chmod 700 "$WORK"
+fi
+
+
+# Limits: the directories kept open while a batch is made stay within the limit on open files
+printf 'make <shard[0000..2999]/logs>;\nif <shard0000> make <flag>;\nmake <shard[0000..2999]/data>;\n' \
+    > "$WORK/limits.pmk"
+for mode in "" "--threads 4" "--io-uring"; do
+    rm -rf "$WORK/run"
+    mkdir "$WORK/run"
+    (ulimit -n 64 && cd "$WORK/run" && "$PM" $mode "$WORK/limits.pmk" > "$WORK/out" 2>&1)
+    made=$(cd "$WORK/run" && find . -mindepth 2 -type d | wc -l)
+    if [ "$made" = 6000 ] && ! grep -q '^Error' "$WORK/out"; then
+        pass
+    else
+        fail "limits (${mode:-sync}): $made of 6000 directories made under 'ulimit -n 64'"
+        grep -m 3 '^Error' "$WORK/out"
+    fi
+done
+
+
+# Cache: trusting the cache saves the stats of the paths already looked at
+for i in $(seq 100); do
+    echo "if <base> make <base/d$i>;"
+done > "$WORK/cache.pmk"
+for policy in trust verify; do
+    rm -rf "$WORK/run"
+    mkdir -p "$WORK/run/base"
+    (cd "$WORK/run" && "$PM" --cache $policy --stats "$WORK/cache.pmk" 2>&1 > /dev/null) > "$WORK/out"
+    stats=$(grep -o '"stat_calls": [0-9]*' "$WORK/out")
+    made=$(ls "$WORK/run/base" | wc -l)
+    expected='"stat_calls": 100'
+    [ $policy = trust ] && expected='"stat_calls": 1'
+    if [ "$stats" = "$expected" ] && [ "$made" = 100 ]; then
+        pass
+    else
+        fail "cache ($policy): $stats and $made directories instead of $expected and 100"
+    fi
+done
+
+
+echo "$PASSED passed, $FAILED failed"
+[ $FAILED = 0 ]